@@ -0,0 +1,139 @@
+#include <iterator>
+
+#include "buffer/access_trace.h"
+
+namespace scudb {
+
+    // first word of a trace file
+    static const uint32_t TRACE_MAGIC = 0x42505452;
+    // records are written to the file in chunks of about this size
+    static const size_t TRACE_BUFFER_SIZE = 64 * 1024;
+
+    AccessTraceRecorder::~AccessTraceRecorder()
+    {
+        Stop();
+    }
+
+    bool AccessTraceRecorder::Start(const std::string &file_name, size_t pool_size)
+    {
+        Stop();
+        std::lock_guard<std::mutex> guard(latch_);
+        file_.open(file_name, std::ios::binary | std::ios::trunc | std::ios::out);
+        if (!file_.is_open())
+        {
+            file_.clear();
+            return false;
+        }
+        uint32_t header[2] = {TRACE_MAGIC, static_cast<uint32_t>(pool_size)};
+        file_.write(reinterpret_cast<const char *>(header), sizeof(header));
+        buffer_.reserve(TRACE_BUFFER_SIZE + 32);
+        start_ = std::chrono::steady_clock::now();
+        last_micros_ = 0;
+        recording_ = true;
+        return true;
+    }
+
+    void AccessTraceRecorder::Stop()
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        if (!recording_)
+        {
+            return;
+        }
+        recording_ = false;
+        flushBuffer();
+        file_.close();
+    }
+
+/*
+ * The time is taken with the latch held, so the records of all threads are
+ * in time order
+ */
+    void AccessTraceRecorder::append(page_id_t page_id, TraceOp op)
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        if (!recording_)
+        {
+            return;
+        }
+        uint64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start_).count();
+        putVarint(((micros - last_micros_) << 2) | static_cast<uint64_t>(op));
+        putVarint(static_cast<uint32_t>(page_id));
+        last_micros_ = micros;
+        if (buffer_.size() >= TRACE_BUFFER_SIZE)
+        {
+            flushBuffer();
+        }
+    }
+
+/*
+ * helper: LEB128, seven bits per byte, lowest first, high bit set on all but
+ * the last byte
+ */
+    void AccessTraceRecorder::putVarint(uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            buffer_.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        buffer_.push_back(static_cast<char>(value));
+    }
+
+    void AccessTraceRecorder::flushBuffer()
+    {
+        file_.write(buffer_.data(), buffer_.size());
+        buffer_.clear();
+    }
+
+    bool AccessTraceRecorder::ReadTrace(const std::string &file_name,
+                                        std::vector<TraceRecord> &records,
+                                        size_t *pool_size)
+    {
+        std::ifstream file(file_name, std::ios::binary);
+        uint32_t header[2];
+        if (!file.read(reinterpret_cast<char *>(header), sizeof(header)) ||
+            header[0] != TRACE_MAGIC)
+        {
+            return false;
+        }
+        if (pool_size != nullptr)
+        {
+            *pool_size = header[1];
+        }
+        std::vector<char> data((std::istreambuf_iterator<char>(file)),
+                               std::istreambuf_iterator<char>());
+
+        records.clear();
+        size_t pos = 0;
+        auto getVarint = [&data, &pos](uint64_t &value) {
+            value = 0;
+            for (int shift = 0; pos < data.size() && shift < 64; shift += 7)
+            {
+                uint8_t byte = static_cast<uint8_t>(data[pos++]);
+                value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if (!(byte & 0x80))
+                {
+                    return true;
+                }
+            }
+            return false;
+        };
+        uint64_t micros = 0;
+        while (pos < data.size())
+        {
+            uint64_t first, pageId;
+            if (!getVarint(first) || !getVarint(pageId))
+            {
+                // a truncated last record, the writer did not finish
+                break;
+            }
+            micros += first >> 2;
+            records.push_back({micros, static_cast<page_id_t>(pageId),
+                               static_cast<TraceOp>(first & 3)});
+        }
+        return true;
+    }
+
+} // namespace scudb
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "buffer/buffer_pool_manager.h"
 #include "common/logger.h"
 
@@ -8,31 +10,76 @@ namespace scudb {
 /*
  * BufferPoolManager Constructor
  * When log_manager is nullptr, logging is disabled (for test purpose)
- * WARNING: Do Not Edit This Function
+ * replacer_type selects the replacement policy of the pool
  */
     BufferPoolManager::BufferPoolManager(size_t pool_size,
                                          DiskManager *disk_manager,
-                                         LogManager *log_manager)
-            : pool_size_(pool_size), disk_manager_(disk_manager),
-              log_manager_(log_manager) {
-        // a consecutive memory space for buffer pool
+                                         LogManager *log_manager,
+                                         ReplacerType replacer_type)
+            : pool_size_(pool_size), page_size_(disk_manager->GetPageSize()),
+              disk_manager_(disk_manager), log_manager_(log_manager),
+              trace_(&trace_recorder_),
+              ring_size_(max<size_t>(1, min<size_t>(BUFFER_POOL_RING_SIZE, pool_size / 8))) {
+        // a consecutive memory space for buffer pool, kept apart from the
+        // frame metadata; the data is aligned so that the disk manager can do
+        // direct I/O on it
         pages_ = new Page[pool_size_];
-        page_table_ = new ExtendibleHash<page_id_t, Page *>(BUCKET_SIZE);
-        replacer_ = new LRUReplacer<Page *>;
+        frame_arena_ = new FrameArena(pool_size_, page_size_);
+        for (size_t i = 0; i < pool_size_; ++i)
+        {
+            pages_[i].data_ = frame_arena_->GetFrame(i);
+            pages_[i].page_size_ = page_size_;
+            pages_[i].ResetMemory();
+        }
+        // a pool never holds more pages than frames, so the table needs no
+        // resizing
+        page_table_ = new LinearProbeHashTable<page_id_t, Page *>(pool_size_);
+        // frames are indexed by their position in pages_
+        Page *pages = pages_;
+        auto frameIndex = [pages](Page *const &page) { return static_cast<size_t>(page - pages); };
+        if (replacer_type == ReplacerType::CLOCK)
+        {
+            replacer_ = new ClockReplacer<Page *>(pool_size_, frameIndex);
+        }
+        else if (replacer_type == ReplacerType::LRU_K)
+        {
+            replacer_ = new LRUKReplacer<Page *>(pool_size_, frameIndex, LRUK_REPLACER_K);
+        }
+        else
+        {
+            replacer_ = new LRUReplacer<Page *>;
+        }
         free_list_ = new std::list<Page *>;
 
-        // put all the pages into free list
+        // put all the pages into free list, owned by the pool
         for (size_t i = 0; i < pool_size_; ++i) {
+            pages_[i].pin_count_ = FRAME_CLAIMED;
             free_list_->push_back(&pages_[i]);
         }
     }
 
+/*
+ * Constructor for a pool without frames of its own, e.g.
+ * ParallelBufferPoolManager which forwards every request to its instances
+ */
+    BufferPoolManager::BufferPoolManager(DiskManager *disk_manager,
+                                         LogManager *log_manager)
+            : pool_size_(0), pages_(nullptr),
+              page_size_(disk_manager->GetPageSize()), frame_arena_(nullptr),
+              disk_manager_(disk_manager),
+              log_manager_(log_manager), page_table_(nullptr),
+              replacer_(nullptr), free_list_(nullptr), trace_(&trace_recorder_),
+              ring_size_(0) {}
+
 /*
  * BufferPoolManager Deconstructor
  * WARNING: Do Not Edit This Function
  */
     BufferPoolManager::~BufferPoolManager() {
+        StopFlushThread();
+        stopPrefetchThread();
         delete[] pages_;
+        delete frame_arena_;
         delete page_table_;
         delete replacer_;
         delete free_list_;
@@ -40,44 +87,283 @@ namespace scudb {
 
 /**
  * 1. search hash table.
- *  1.1 if exist, pin the page and return immediately
+ *  1.0 if exist and readable, pin the page without taking the latch, see
+ *  pinResident()
+ *  1.1 if exist, pin the page and return immediately (after waiting for the
+ *  frame if another thread is still reading the page in)
  *  1.2 if no exist, find a replacement entry from either free list or lru
  * replacer. (NOTE: always find from free list first)
- * 2. If the entry chosen for replacement is dirty, write it back to disk.
- * 3. Delete the entry for the old page from the hash table and insert an
- * entry for the new page.
- * 4. Update page metadata, read page content from disk file and return page
- * pointer
+ * 2. Delete the entry for the old page from the hash table and insert an
+ * entry for the new page, so that concurrent requesters of the page wait on
+ * the frame instead of reading it twice.
+ * 3. Release the latch, write the old page back if it was dirty and read the
+ * new page content from disk file, then return page pointer
+ * strategy mostly matters for a miss, see findUnusedPage(); a hit of a bulk
+ * access is not reported to the replacer either, a scan uses its pages once
+ * no matter how often it fetches them
+ * If all frames are pinned, the miss may wait for one, see
+ * SetFrameWaitTimeout(); the page is looked up again after every wait.
  */
-    Page *BufferPoolManager::FetchPage(page_id_t page_id)
+    Page *BufferPoolManager::FetchPage(page_id_t page_id, AccessStrategy strategy)
     {
-        lock_guard<mutex> guard(latch_);
-
-        Page *targetPage = nullptr;
-        if (page_table_->Find(page_id, targetPage))
-        {// if exists, pin the page and return immediately
-            targetPage->pin_count_++;
-            // replacer only record those Page pin_count == 0, so it will be erased from the replacer_
-            replacer_->Erase(targetPage);
+        Page *targetPage = pinResident(page_id);
+        if (targetPage != nullptr)
+        {
+            stats_.Add(BufferPoolStatsCollector::FETCH_HITS);
+            // the replacer records the access without a latch as well
+            if (strategy == AccessStrategy::NORMAL)
+            {
+                replacer_->RecordAccess(targetPage);
+            }
+            trace_->Record(page_id, TraceOp::FETCH);
             return targetPage;
         }
-        else
+
+        unique_lock<mutex> lock = lockLatch();
+        FrameWait wait;
+        page_id_t oldPageId;
+        bool writeBack;
+        while (true)
+        {
+            if (page_table_->Find(page_id, targetPage))
+            {// if exists, pin the page and return once it is readable
+                leaveFrameQueue(wait, true);
+                stats_.Add(BufferPoolStatsCollector::FETCH_HITS);
+                // a frame in the page table is never claimed while we hold
+                // the latch; the replacer finds out about the pin lazily
+                targetPage->pin_count_++;
+                if (strategy == AccessStrategy::NORMAL)
+                {
+                    replacer_->RecordAccess(targetPage);
+                }
+                while (targetPage->is_loading_)
+                {
+                    targetPage->io_cv_.wait(lock);
+                }
+                trace_->Record(page_id, TraceOp::FETCH);
+                return targetPage;
+            }
+            if (evicting_.find(page_id) != evicting_.end())
+            {
+                // the latest contents of this page are still on their way to disk
+                evict_cv_.wait(lock);
+                continue;
+            }
+            if (isFrameTurn(wait))
+            {
+                targetPage = installPage(page_id, oldPageId, writeBack, strategy);
+                if (targetPage != nullptr)
+                {
+                    break;
+                }
+            }
+            if (!waitForFrame(lock, wait))
+            {
+                leaveFrameQueue(wait, false);
+                return nullptr;
+            }
+        }
+
+        leaveFrameQueue(wait, true);
+        stats_.Add(BufferPoolStatsCollector::FETCH_MISSES);
+        replacer_->RecordAccess(targetPage);
+        // a hint for the page is stale now, the prefetch thread would read
+        // it again once the page is gone, e.g. recycled by a scan
+        if (!prefetch_queue_.empty())
         {
-            targetPage = findUnusedPage();
-            if (targetPage == nullptr)
+            prefetch_queue_.erase(
+                remove_if(prefetch_queue_.begin(), prefetch_queue_.end(),
+                          [page_id](const pair<page_id_t, AccessStrategy> &request) {
+                              return request.first == page_id; }),
+                prefetch_queue_.end());
+        }
+        finishInstall(lock, targetPage, oldPageId, writeBack, true);
+        trace_->Record(page_id, TraceOp::FETCH);
+        return targetPage;
+    }
+
+/*
+ * Optimistic hit: pin the frame page_id maps to with a compare and swap and
+ * check that the frame still holds page_id afterwards, all without the latch.
+ * The page table lookup may be stale, but a claimed frame cannot be pinned
+ * and a frame that holds another page or is still loading is given up again.
+ * The frame stays in the replacer, victim selection skips pinned frames.
+ * return nullptr if the slow path has to decide
+ */
+    Page *BufferPoolManager::pinResident(page_id_t page_id)
+    {
+        Page *page = nullptr;
+        if (!page_table_->Find(page_id, page))
+        {
+            return nullptr;
+        }
+        int pins = page->pin_count_.load();
+        do
+        {
+            if (pins == FRAME_CLAIMED)
             {
                 return nullptr;
             }
+        } while (!page->pin_count_.compare_exchange_weak(pins, pins + 1));
+        if (page->page_id_ == page_id && !page->is_loading_)
+        {
+            return page;
+        }
+        if (unpinFrame(page))
+        {
+            notifyFrameWaiters();
+        }
+        return nullptr;
+    }
+
+/*
+ * Take ownership of an unpinned frame, so that nobody can pin it until it
+ * holds its new page. return false if it is pinned
+ */
+    bool BufferPoolManager::claimFrame(Page *page)
+    {
+        int unpinned = 0;
+        return page->pin_count_.compare_exchange_strong(unpinned, FRAME_CLAIMED);
+    }
 
-            disk_manager_->ReadPage(page_id, targetPage->GetData());
-            targetPage->pin_count_ = 1;
-            targetPage->page_id_ = page_id;
+/*
+ * Drop a pin; the last one makes the frame a candidate for eviction again,
+ * since a victim selection may have dropped it from the replacer meanwhile.
+ * return true if that was the last pin, waiters for a frame need to be told
+ */
+    bool BufferPoolManager::unpinFrame(Page *page)
+    {
+        if (page->pin_count_.fetch_sub(1) == 1)
+        {
+            replacer_->Insert(page);
+            return true;
+        }
+        return false;
+    }
 
-            page_table_->Insert(page_id, targetPage);
+/*
+ * Requests that find all frames pinned queue up in frame_waiters_ and only
+ * the oldest one tries to get a frame, so a burst of requests is served in
+ * arrival order instead of whoever happens to wake up first. Before it is
+ * queued a request may only try if nobody is waiting.
+ */
+    bool BufferPoolManager::isFrameTurn(const FrameWait &wait)
+    {
+        if (wait.ticket == 0)
+        {
+            return frame_waiters_.empty();
+        }
+        return frame_waiters_.front() == wait.ticket;
+    }
 
-            assert(!targetPage->is_dirty_);
+/*
+ * Called with the latch held after a request did not get a frame. The first
+ * call queues the request and returns right away, so that it tries once more
+ * as a waiter (an unpin in between only wakes up queued requests); later
+ * calls wait for a frame to be unpinned. return false once the timeout is
+ * over, or if waiting is disabled
+ */
+    bool BufferPoolManager::waitForFrame(unique_lock<mutex> &lock, FrameWait &wait)
+    {
+        if (wait.ticket == 0)
+        {
+            if (frame_wait_timeout_.count() == 0)
+            {
+                return false;
+            }
+            wait.ticket = next_frame_ticket_++;
+            wait.startNanos = BufferPoolStatsCollector::NowNanos();
+            wait.deadline = chrono::steady_clock::now() + frame_wait_timeout_;
+            frame_waiters_.push_back(wait.ticket);
+            num_frame_waiters_++;
+            return true;
         }
-        return targetPage;
+        return frame_cv_.wait_until(lock, wait.deadline) == cv_status::no_timeout;
+    }
+
+/*
+ * Take a request out of the queue, with the latch held, and record how long
+ * it waited; the next one may be able to get a frame now
+ */
+    void BufferPoolManager::leaveFrameQueue(FrameWait &wait, bool got_frame)
+    {
+        if (wait.ticket == 0)
+        {
+            return;
+        }
+        frame_waiters_.erase(find(frame_waiters_.begin(), frame_waiters_.end(), wait.ticket));
+        num_frame_waiters_--;
+        wait.ticket = 0;
+        frame_cv_.notify_all();
+        stats_.Record(BufferPoolStatsCollector::FRAME_WAIT,
+                      BufferPoolStatsCollector::NowNanos() - wait.startNanos);
+        if (!got_frame)
+        {
+            stats_.Add(BufferPoolStatsCollector::FRAME_WAIT_TIMEOUTS);
+        }
+    }
+
+/*
+ * A frame was unpinned without the latch held. Waiters are queued with the
+ * latch held and only then look for a frame, so either they see this frame
+ * or this sees them; taking the latch makes sure they are already waiting.
+ */
+    void BufferPoolManager::notifyFrameWaiters()
+    {
+        if (num_frame_waiters_ > 0)
+        {
+            lock_guard<mutex> guard(latch_);
+            frame_cv_.notify_all();
+        }
+    }
+
+    void BufferPoolManager::SetFrameWaitTimeout(chrono::milliseconds timeout)
+    {
+        lock_guard<mutex> guard(latch_);
+        frame_wait_timeout_ = timeout;
+    }
+
+/*
+ * A frame is listed with the recLSN of its current contents, and with the
+ * one of the write in progress until that write is done. A change may be
+ * made to a pinned page after its log record got an LSN but before
+ * SetLSN(), so the LSN of a checkpoint must be taken before this is called.
+ */
+    void BufferPoolManager::GetDirtyPageTable(vector<pair<page_id_t, lsn_t>> &dirty_pages)
+    {
+        lock_guard<mutex> guard(latch_);
+        for (size_t i = 0; i < pool_size_; ++i)
+        {
+            Page *page = &pages_[i];
+            lsn_t recLsn = page->rec_lsn_;
+            page_id_t pageId = page->page_id_;
+            if (recLsn != INVALID_LSN && pageId != INVALID_PAGE_ID)
+            {
+                dirty_pages.emplace_back(pageId, recLsn);
+            }
+            if (page->write_rec_lsn_ != INVALID_LSN)
+            {
+                dirty_pages.emplace_back(page->write_page_id_, page->write_rec_lsn_);
+            }
+        }
+    }
+
+/*
+ * Fetch the page and latch it in shared mode. The returned guard releases
+ * both the latch and the pin, so callers need no second FetchPage to find the
+ * page again when they are done. An empty guard means FetchPage failed.
+ */
+    ReadPageGuard BufferPoolManager::FetchPageRead(page_id_t page_id, AccessStrategy strategy)
+    {
+        return ReadPageGuard(this, FetchPage(page_id, strategy));
+    }
+
+/*
+ * Same as above, with the latch in exclusive mode
+ */
+    WritePageGuard BufferPoolManager::FetchPageWrite(page_id_t page_id, AccessStrategy strategy)
+    {
+        return WritePageGuard(this, FetchPage(page_id, strategy));
     }
 
 /*
@@ -85,29 +371,39 @@ namespace scudb {
  * if pin_count>0, decrement it and if it becomes zero, put it back to
  * replacer if pin_count<=0 before this call, return false. is_dirty: set the
  * dirty flag of this page
+ * The caller's pin keeps the frame from being reused, so this needs no
+ * latch. The dirty flag is set before the pin is dropped, an eviction
+ * claiming the frame afterwards sees it.
  */
     bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty)
     {
-        lock_guard<mutex> guard(latch_);
-
         Page *page = nullptr;
         if (!page_table_->Find(page_id, page))
         {
             return false;
         }
-        if (page->pin_count_ == 0)
+        int pins = page->pin_count_.load();
+        if (pins <= 0)
         {
             return false;
         }
-        page->pin_count_--;
-        if (page->pin_count_ == 0)
-        {
-            replacer_->Insert(page);
-        }
         if (is_dirty)
         {
             page->is_dirty_ = true;
         }
+        do
+        {
+            if (pins <= 0)
+            {
+                return false;
+            }
+        } while (!page->pin_count_.compare_exchange_weak(pins, pins - 1));
+        if (pins == 1)
+        {
+            replacer_->Insert(page);
+            notifyFrameWaiters();
+        }
+        trace_->Record(page_id, TraceOp::UNPIN);
         return true;
     }
 
@@ -115,26 +411,539 @@ namespace scudb {
  * Used to flush a particular page of the buffer pool to disk. Should call the
  * write_page method of the disk manager
  * if page is not found in page table, return false
+ * The write happens without holding the latch. The frame is marked as
+ * flushing meanwhile, so it is neither reused nor written by another flush
+ * until the write completes.
  * NOTE: make sure page_id != INVALID_PAGE_ID
  */
     bool BufferPoolManager::FlushPage(page_id_t page_id)
     {
-        lock_guard<mutex> guard(latch_);
+        unique_lock<mutex> lock = lockLatch();
 
         assert(page_id != INVALID_PAGE_ID);
         Page *page = nullptr;
-        if (!page_table_->Find(page_id, page))
+        while (true)
         {
-            return false;
+            if (!page_table_->Find(page_id, page))
+            {
+                return false;
+            }
+            if (!page->is_loading_ && !page->is_flushing_)
+            {
+                break;
+            }
+            page->io_cv_.wait(lock);
         }
         if (page->is_dirty_)
         {
-            disk_manager_->WritePage(page_id, page->GetData());
-            page->is_dirty_ = false;
+            flushFrame(lock, page);
         }
         return true;
     }
 
+/*
+ * Write a dirty, settled frame back without holding the latch. The frame is
+ * marked as flushing meanwhile, which keeps it from being reused or written
+ * by somebody else, but unlike a pin leaves its place in the replacer alone.
+ */
+    void BufferPoolManager::flushFrame(unique_lock<mutex> &lock, Page *page)
+    {
+        assert(page->is_dirty_ && !page->is_loading_ && !page->is_flushing_);
+        page_id_t page_id = page->page_id_;
+        page->is_flushing_ = true;
+        page->is_dirty_ = false;
+        beginWrite(page, page_id);
+        lock.unlock();
+        writePage(page_id, page->GetData());
+        lock.lock();
+        endWrite(page);
+        page->is_flushing_ = false;
+        page->io_cv_.notify_all();
+    }
+
+/*
+ * Write every dirty page to disk and sync the file once at the end, e.g. for
+ * a checkpoint or before shutdown. The pages are written in page id order, so
+ * that the disk manager can write runs of adjacent pages with one system call
+ * each instead of one write per page. Pages dirtied while this is in progress
+ * may or may not be written.
+ */
+    void BufferPoolManager::FlushAllPages()
+    {
+        vector<pair<page_id_t, Page *>> frames;
+        beginFlushAll(frames);
+        writeFlushAll(frames);
+        endFlushAll(frames);
+        disk_manager_->SyncPages();
+    }
+
+/*
+ * Mark the dirty frames as flushing, as flushFrame() does, and add them to
+ * frames. Writes that are already in progress, by a FlushPage(), the flush
+ * thread or a miss evicting a dirty page, are waited for first, so that the
+ * sync covers them too.
+ */
+    void BufferPoolManager::beginFlushAll(vector<pair<page_id_t, Page *>> &frames)
+    {
+        unique_lock<mutex> lock = lockLatch();
+        vector<page_id_t> evicting(evicting_.begin(), evicting_.end());
+        for (page_id_t page_id : evicting)
+        {
+            while (evicting_.find(page_id) != evicting_.end())
+            {
+                evict_cv_.wait(lock);
+            }
+        }
+        for (size_t i = 0; i < pool_size_; ++i)
+        {
+            Page *page = &pages_[i];
+            while (page->is_flushing_)
+            {
+                page->io_cv_.wait(lock);
+            }
+            // a loading frame is never dirty, see installPage()
+            if (page->page_id_ != INVALID_PAGE_ID && page->is_dirty_ && !page->is_loading_)
+            {
+                page->is_flushing_ = true;
+                page->is_dirty_ = false;
+                beginWrite(page, page->page_id_);
+                frames.emplace_back(page->page_id_, page);
+            }
+        }
+    }
+
+/*
+ * Write the marked frames sorted by page id, without holding any latch. The
+ * whole batch is timed as one disk write.
+ */
+    void BufferPoolManager::writeFlushAll(vector<pair<page_id_t, Page *>> frames)
+    {
+        if (frames.empty())
+        {
+            return;
+        }
+        sort(frames.begin(), frames.end());
+        vector<pair<page_id_t, const char *>> pages;
+        for (auto &frame : frames)
+        {
+            forceLog(frame.second->GetData());
+            pages.emplace_back(frame.first, frame.second->GetData());
+        }
+        uint64_t start = BufferPoolStatsCollector::NowNanos();
+        disk_manager_->WritePages(pages);
+        stats_.Record(BufferPoolStatsCollector::DISK_WRITE,
+                      BufferPoolStatsCollector::NowNanos() - start);
+        stats_.Add(BufferPoolStatsCollector::DIRTY_WRITE_BACKS, frames.size());
+    }
+
+    void BufferPoolManager::endFlushAll(const vector<pair<page_id_t, Page *>> &frames)
+    {
+        unique_lock<mutex> lock = lockLatch();
+        for (auto &frame : frames)
+        {
+            endWrite(frame.second);
+            frame.second->is_flushing_ = false;
+            frame.second->io_cv_.notify_all();
+        }
+    }
+
+/*
+ * Start a thread that wakes up every BUFFER_POOL_FLUSH_TIMEOUT, or when a miss
+ * had to write a dirty victim itself, and writes dirty unpinned frames until
+ * at least clean_ratio of the unpinned frames are clean, so that misses find
+ * clean victims
+ */
+    void BufferPoolManager::RunFlushThread(double clean_ratio)
+    {
+        lock_guard<mutex> guard(latch_);
+        assert(clean_ratio >= 0 && clean_ratio <= 1);
+        clean_ratio_ = clean_ratio;
+        if (flush_thread_ == nullptr)
+        {
+            flush_running_ = true;
+            flush_thread_ = new thread(&BufferPoolManager::flushThread, this);
+        }
+    }
+
+/*
+ * Stop and join the flush thread
+ */
+    void BufferPoolManager::StopFlushThread()
+    {
+        {
+            lock_guard<mutex> guard(latch_);
+            if (flush_thread_ == nullptr)
+            {
+                return;
+            }
+            flush_running_ = false;
+            flush_cv_.notify_one();
+        }
+        flush_thread_->join();
+        delete flush_thread_;
+        flush_thread_ = nullptr;
+    }
+
+    void BufferPoolManager::flushThread()
+    {
+        unique_lock<mutex> lock(latch_);
+        size_t cursor = 0;
+        while (flush_running_)
+        {
+            size_t unpinned = 0;
+            size_t clean = 0;
+            for (size_t i = 0; i < pool_size_; ++i)
+            {
+                Page *page = &pages_[i];
+                if (page->page_id_ != INVALID_PAGE_ID && page->pin_count_ == 0)
+                {
+                    unpinned++;
+                    if (!page->is_dirty_)
+                    {
+                        clean++;
+                    }
+                }
+            }
+
+            // pick dirty unpinned frames round robin and write them as one
+            // batch of asynchronous I/O, marked as flushing like in
+            // flushFrame(); the frames may change while the batch is in
+            // progress, so every round checks them again
+            size_t target = static_cast<size_t>(clean_ratio_ * unpinned + 0.5);
+            for (size_t i = 0; i < pool_size_ && clean < target && flush_running_;)
+            {
+                vector<Page *> batch;
+                for (; i < pool_size_ && clean + batch.size() < target &&
+                       batch.size() < ASYNC_IO_DEPTH; ++i)
+                {
+                    Page *page = &pages_[cursor];
+                    cursor = (cursor + 1) % pool_size_;
+                    if (page->page_id_ != INVALID_PAGE_ID && page->pin_count_ == 0 &&
+                        page->is_dirty_ && !page->is_loading_ && !page->is_flushing_)
+                    {
+                        page->is_flushing_ = true;
+                        page->is_dirty_ = false;
+                        beginWrite(page, page->page_id_);
+                        batch.push_back(page);
+                    }
+                }
+                vector<page_id_t> pageIds;
+                for (Page *page : batch)
+                {
+                    pageIds.push_back(page->page_id_);
+                }
+
+                lock.unlock();
+                uint64_t start = BufferPoolStatsCollector::NowNanos();
+                vector<future<void>> writes;
+                for (size_t j = 0; j < batch.size(); ++j)
+                {
+                    forceLog(batch[j]->GetData());
+                    writes.push_back(disk_manager_->WritePageAsync(pageIds[j], batch[j]->GetData()));
+                }
+                for (auto &write : writes)
+                {
+                    write.wait();
+                    stats_.Record(BufferPoolStatsCollector::DISK_WRITE,
+                                  BufferPoolStatsCollector::NowNanos() - start);
+                }
+                stats_.Add(BufferPoolStatsCollector::DIRTY_WRITE_BACKS, batch.size());
+                lock.lock();
+
+                for (Page *page : batch)
+                {
+                    endWrite(page);
+                    page->is_flushing_ = false;
+                    page->io_cv_.notify_all();
+                }
+                num_background_writes_ += batch.size();
+                clean += batch.size();
+            }
+
+            if (flush_running_)
+            {
+                flush_cv_.wait_for(lock, BUFFER_POOL_FLUSH_TIMEOUT);
+            }
+        }
+    }
+
+/*
+ * Queue page_ids to be read in by the prefetch thread. The pages end up
+ * unpinned in the replacer, as if they had been fetched and unpinned. At most
+ * pool_size requests are kept, older ones are dropped since reading them
+ * would only evict the newer ones again. The pages are read with strategy,
+ * like a FetchPage of the requester would. Resident pages are not queued,
+ * nor kept queued once a FetchPage read them, the thread could only read
+ * them a second time after they are gone.
+ */
+    void BufferPoolManager::PrefetchPages(const vector<page_id_t> &page_ids,
+                                          AccessStrategy strategy)
+    {
+        lock_guard<mutex> guard(latch_);
+        Page *page;
+        for (page_id_t page_id : page_ids)
+        {
+            assert(page_id != INVALID_PAGE_ID);
+            if (page_table_->Find(page_id, page))
+            {
+                continue;
+            }
+            if (prefetch_queue_.size() >= pool_size_)
+            {
+                prefetch_queue_.pop_front();
+            }
+            prefetch_queue_.emplace_back(page_id, strategy);
+        }
+        if (prefetch_thread_ == nullptr)
+        {
+            prefetch_running_ = true;
+            prefetch_thread_ = new thread(&BufferPoolManager::prefetchThread, this);
+        }
+        prefetch_cv_.notify_one();
+    }
+
+    void BufferPoolManager::stopPrefetchThread()
+    {
+        {
+            lock_guard<mutex> guard(latch_);
+            if (prefetch_thread_ == nullptr)
+            {
+                return;
+            }
+            prefetch_running_ = false;
+            prefetch_cv_.notify_one();
+            frame_cv_.notify_all();
+            prefetch_done_cv_.notify_all();
+        }
+        prefetch_thread_->join();
+        delete prefetch_thread_;
+        prefetch_thread_ = nullptr;
+    }
+
+/*
+ * Read queued pages the same way a miss of FetchPage does, up to
+ * ASYNC_IO_DEPTH of them at once. The frame stays
+ * pinned while it is loading, which keeps it out of the replacer; a FetchPage
+ * of the page in the meantime simply waits for the read to complete.
+ */
+    void BufferPoolManager::prefetchThread()
+    {
+        unique_lock<mutex> lock(latch_);
+        while (true)
+        {
+            while (prefetch_running_ && prefetch_queue_.empty())
+            {
+                prefetch_cv_.wait(lock);
+            }
+            if (!prefetch_running_)
+            {
+                return;
+            }
+            // install frames for a batch of requests
+            struct Load
+            {
+                Page *page;
+                page_id_t pageId;
+                page_id_t oldPageId;
+                bool writeBack;
+            };
+            vector<Load> loads;
+            // requests waiting for a frame come first
+            while (!prefetch_queue_.empty() && loads.size() < ASYNC_IO_DEPTH &&
+                   frame_waiters_.empty())
+            {
+                Load load;
+                load.pageId = prefetch_queue_.front().first;
+                AccessStrategy strategy = prefetch_queue_.front().second;
+                prefetch_queue_.pop_front();
+                if (page_table_->Find(load.pageId, load.page) ||
+                    evicting_.find(load.pageId) != evicting_.end())
+                {
+                    // already resident, or about to be written and read again
+                    continue;
+                }
+                load.page = installPage(load.pageId, load.oldPageId, load.writeBack, strategy);
+                if (load.page == nullptr)
+                {
+                    // every frame is pinned, a hint is not worth waiting for
+                    prefetch_queue_.clear();
+                    break;
+                }
+                loads.push_back(load);
+            }
+            if (loads.empty())
+            {
+                if (!prefetch_queue_.empty())
+                {
+                    // let the requests waiting for a frame go first
+                    frame_cv_.wait(lock);
+                }
+                prefetch_done_cv_.notify_all();
+                continue;
+            }
+            // a FlushPage() may still be writing the previous contents
+            for (auto &load : loads)
+            {
+                while (load.page->is_flushing_)
+                {
+                    load.page->io_cv_.wait(lock);
+                }
+            }
+
+            // as in finishInstall(), but all write backs and then all reads
+            // are in flight at the same time
+            // each I/O is timed from the submission of its batch
+            prefetch_busy_ = true;
+            lock.unlock();
+            uint64_t start = BufferPoolStatsCollector::NowNanos();
+            vector<future<void>> ios;
+            for (auto &load : loads)
+            {
+                if (load.writeBack)
+                {
+                    forceLog(load.page->GetData());
+                    ios.push_back(disk_manager_->WritePageAsync(load.oldPageId, load.page->GetData()));
+                }
+            }
+            for (auto &io : ios)
+            {
+                io.wait();
+                stats_.Record(BufferPoolStatsCollector::DISK_WRITE,
+                              BufferPoolStatsCollector::NowNanos() - start);
+            }
+            stats_.Add(BufferPoolStatsCollector::DIRTY_WRITE_BACKS, ios.size());
+            ios.clear();
+            start = BufferPoolStatsCollector::NowNanos();
+            for (auto &load : loads)
+            {
+                load.page->ResetMemory();
+                ios.push_back(disk_manager_->ReadPageAsync(load.pageId, load.page->GetData()));
+            }
+            for (auto &io : ios)
+            {
+                io.wait();
+                stats_.Record(BufferPoolStatsCollector::DISK_READ,
+                              BufferPoolStatsCollector::NowNanos() - start);
+            }
+            lock.lock();
+
+            for (auto &load : loads)
+            {
+                completeInstall(load.page, load.oldPageId, true);
+                if (unpinFrame(load.page))
+                {
+                    frame_cv_.notify_all();
+                }
+            }
+            prefetch_busy_ = false;
+            prefetch_done_cv_.notify_all();
+        }
+    }
+
+/*
+ * The trace gets the total pool size, for a ParallelBufferPoolManager the
+ * sum over its instances
+ */
+    bool BufferPoolManager::StartTrace(const std::string &file_name)
+    {
+        return trace_->Start(file_name, GetPoolSize());
+    }
+
+    void BufferPoolManager::StopTrace()
+    {
+        trace_->Stop();
+    }
+
+/*
+ * helper: wait until the prefetch thread has read in every queued page
+ */
+    void BufferPoolManager::waitForPrefetch()
+    {
+        unique_lock<mutex> lock(latch_);
+        while (prefetch_running_ && (!prefetch_queue_.empty() || prefetch_busy_))
+        {
+            prefetch_done_cv_.wait(lock);
+        }
+    }
+
+/*
+ * The pinned pages come first, they are in use right now, followed by the
+ * unpinned ones in the order of the replacer. Pages only held by a ring of
+ * a bulk access are not in the replacer and are left out, they were read
+ * once by a scan.
+ */
+    void BufferPoolManager::SaveWarmupList()
+    {
+        disk_manager_->WriteWarmupList(residentPages());
+    }
+
+    size_t BufferPoolManager::WarmUp(bool wait)
+    {
+        size_t numQueued = queueWarmup(disk_manager_->ReadWarmupList());
+        if (wait)
+        {
+            waitForPrefetch();
+        }
+        return numQueued;
+    }
+
+/*
+ * helper: ids of the resident pages, see SaveWarmupList()
+ */
+    vector<page_id_t> BufferPoolManager::residentPages()
+    {
+        lock_guard<mutex> guard(latch_);
+        vector<page_id_t> pageIds;
+        vector<bool> listed(pool_size_, false);
+        for (size_t i = 0; i < pool_size_; ++i)
+        {
+            if (pages_[i].pin_count_ > 0 && pages_[i].page_id_ != INVALID_PAGE_ID)
+            {
+                listed[i] = true;
+                pageIds.push_back(pages_[i].page_id_);
+            }
+        }
+        // pinned frames may still be in the replacer, it learns about pins lazily
+        for (Page *page : replacer_->HotnessOrder())
+        {
+            size_t frame = page - pages_;
+            if (!listed[frame] && page->pin_count_ == 0 && page->page_id_ != INVALID_PAGE_ID)
+            {
+                listed[frame] = true;
+                pageIds.push_back(page->page_id_);
+            }
+        }
+        return pageIds;
+    }
+
+/*
+ * helper: prefetch the hottest of page_ids, as many as there are free frames
+ * so that warming up never evicts a page that was read in since the start.
+ * They are requested in batches of BUFFER_POOL_WARMUP_BATCH, hottest batch
+ * first, each sorted by page id so that the disk reads it mostly
+ * sequentially. return the number of pages requested
+ */
+    size_t BufferPoolManager::queueWarmup(const vector<page_id_t> &page_ids)
+    {
+        size_t numFree;
+        {
+            lock_guard<mutex> guard(latch_);
+            numFree = free_list_->size();
+        }
+        vector<page_id_t> ordered(page_ids.begin(),
+                                  page_ids.begin() + min(numFree, page_ids.size()));
+        for (size_t start = 0; start < ordered.size(); start += BUFFER_POOL_WARMUP_BATCH)
+        {
+            auto end = ordered.begin() + min(ordered.size(), start + BUFFER_POOL_WARMUP_BATCH);
+            sort(ordered.begin() + start, end);
+        }
+        if (!ordered.empty())
+        {
+            PrefetchPages(ordered);
+        }
+        return ordered.size();
+    }
+
 /**
  * User should call this method for deleting a page. This routine will call
  * disk manager to deallocate the page. First, if page is found within page
@@ -145,27 +954,40 @@ namespace scudb {
  */
     bool BufferPoolManager::DeletePage(page_id_t page_id)
     {
-        lock_guard<mutex> guard(latch_);
+        unique_lock<mutex> lock = lockLatch();
         Page *page = nullptr;
-        if (page_table_->Find(page_id, page))
+        while (page_table_->Find(page_id, page))
         {
-            if (page->GetPinCount() != 0)
+            if (page->is_flushing_)
+            {
+                page->io_cv_.wait(lock);
+                continue;
+            }
+            if (!claimFrame(page))
             {
                 // some User is using this page, can not delete
                 return false;
             }
-            // reset Page
+            // reset Page, it stays claimed on the free list
             page->page_id_ = INVALID_PAGE_ID;
-            page->pin_count_ = 0;
             page->is_dirty_ = false;
+            page->rec_lsn_ = INVALID_LSN;
             page->ResetMemory();
 
-            replacer_->Erase(page);
+            replacer_->Remove(page);
             page_table_->Remove(page_id);
             free_list_->push_back(page);
+            frame_cv_.notify_all();
+            break;
+        }
+        // do not let a pending write back land after the deallocation
+        while (evicting_.find(page_id) != evicting_.end())
+        {
+            evict_cv_.wait(lock);
         }
 
         disk_manager_->DeallocatePage(page_id);
+        trace_->Record(page_id, TraceOp::DELETE);
         return true;
     }
 
@@ -179,33 +1001,90 @@ namespace scudb {
  */
     Page *BufferPoolManager::NewPage(page_id_t &page_id)
     {
-        lock_guard<mutex> guard(latch_);
-
-        Page *newPage = nullptr;
-        newPage = findUnusedPage();
-
+        // allocating may write the free space bitmap, so do it before taking
+        // the latch and give the id back if there is no frame for it
+        page_id_t newPageId = disk_manager_->AllocatePage();
+        Page *newPage = newPageWithId(newPageId);
         if (newPage == nullptr)
         {
+            stats_.Add(BufferPoolStatsCollector::NEW_PAGE_FAILURES);
+            disk_manager_->DeallocatePage(newPageId);
             return newPage;
         }
+        page_id = newPageId;
+        return newPage;
+    }
 
-        // now newPage is clear
-        page_id = disk_manager_->AllocatePage();
-        newPage->page_id_ = page_id;
-        newPage->is_dirty_ = true;
-        newPage->pin_count_ = 1;
-
-        page_table_->Insert(newPage->page_id_, newPage);
+/**
+ * Same as NewPage, but the caller has already allocated page_id from the disk
+ * manager. return nullptr if all the pages in pool are pinned (after waiting
+ * for one, if wait is set and waiting is enabled)
+ */
+    Page *BufferPoolManager::newPageWithId(page_id_t page_id, bool wait)
+    {
+        unique_lock<mutex> lock = lockLatch();
 
+        FrameWait frameWait;
+        page_id_t oldPageId;
+        bool writeBack;
+        Page *newPage = nullptr;
+        while (true)
+        {
+            if (isFrameTurn(frameWait))
+            {
+                newPage = installPage(page_id, oldPageId, writeBack);
+                if (newPage != nullptr)
+                {
+                    break;
+                }
+            }
+            if (!wait || !waitForFrame(lock, frameWait))
+            {
+                break;
+            }
+        }
+        leaveFrameQueue(frameWait, newPage != nullptr);
+        if (newPage == nullptr)
+        {
+            return newPage;
+        }
+        replacer_->RecordAccess(newPage);
+        finishInstall(lock, newPage, oldPageId, writeBack, false);
+        trace_->Record(page_id, TraceOp::NEW);
         return newPage;
     }
 
 /**
  * find unused page from free list first than replacer, return null if not enough memory
+ * the returned page is off both lists and claimed, but still carries its old
+ * identity
+ * A bulk access whose ring is full recycles the oldest frame of the ring
+ * instead, if that frame still holds the page the ring put there and is
+ * unused (and clean, for a bulk read). Otherwise the frame leaves the ring
+ * and a regular victim takes its place, see installPage().
  */
-    Page *BufferPoolManager::findUnusedPage()
+    Page *BufferPoolManager::findUnusedPage(AccessStrategy strategy)
     {
         Page *page;
+        if (strategy != AccessStrategy::NORMAL)
+        {
+            auto &ring = rings_[strategy == AccessStrategy::BULK_READ ? 0 : 1];
+            if (ring.size() >= ring_size_)
+            {
+                page = ring.front().first;
+                page_id_t ringPageId = ring.front().second;
+                ring.pop_front();
+                if (page->page_id_ == ringPageId && !page->is_loading_ &&
+                    !page->is_flushing_ &&
+                    (strategy == AccessStrategy::BULK_WRITE || !page->is_dirty_) &&
+                    claimFrame(page))
+                {
+                    // the frame gets another page, which starts without history
+                    replacer_->Remove(page);
+                    return page;
+                }
+            }
+        }
         if (!free_list_->empty())
         {
             // fetch Page from free list first
@@ -213,29 +1092,237 @@ namespace scudb {
             free_list_->pop_front();
 
             assert(page->page_id_ == INVALID_PAGE_ID);
-            assert(page->pin_count_ == 0);
+            assert(page->pin_count_ == FRAME_CLAIMED);
             assert(!page->is_dirty_);
         }
         else
         {
-            // fetch Page from replacer
-            if (!replacer_->Victim(page))
+            // fetch Page from replacer, a clean one saves a write; the
+            // replacer may still hold frames pinned by a hit since, those
+            // are dropped and put back by their last unpin
+            auto preferred = [](Page *const &p) {
+                return p->pin_count_ == 0 && !p->is_dirty_ && !p->is_flushing_; };
+            do
             {
-                return nullptr;
-            }
+                if (!replacer_->VictimPreferring(page, preferred))
+                {
+                    return nullptr;
+                }
+            } while (!claimFrame(page));
+            assert(!page->is_loading_);
+        }
+        return page;
+    }
+
+/**
+ * Take an unused frame and give it the identity of page_id (which may be
+ * INVALID_PAGE_ID if the caller fills it in). The frame is pinned and marked
+ * as loading, so everyone else asking for page_id waits on this frame until
+ * finishInstall() completes. If the old page of the frame was dirty it is
+ * recorded in evicting_ and write_back is set; the same goes for an old page
+ * that is being flushed, though it does not have to be written again.
+ * Must be called with latch_ held. return nullptr if all the pages are pinned
+ */
+    Page *BufferPoolManager::installPage(page_id_t page_id,
+                                         page_id_t &old_page_id,
+                                         bool &write_back,
+                                         AccessStrategy strategy)
+    {
+        Page *page = findUnusedPage(strategy);
+        if (page == nullptr)
+        {
+            return nullptr;
+        }
+        if (strategy != AccessStrategy::NORMAL)
+        {
+            rings_[strategy == AccessStrategy::BULK_READ ? 0 : 1].emplace_back(page, page_id);
+        }
 
-            // write page back to disk
-            assert(page->pin_count_ == 0);
-            page_table_->Remove(page->page_id_);
-            if (page->is_dirty_)
+        old_page_id = page->page_id_;
+        write_back = page->is_dirty_;
+        if (old_page_id != INVALID_PAGE_ID)
+        {
+            stats_.Add(BufferPoolStatsCollector::EVICTIONS);
+            page_table_->Remove(old_page_id);
+            if (write_back || page->is_flushing_)
             {
-                disk_manager_->WritePage(page->page_id_, page->GetData());
-                page->is_dirty_ = false;
+                evicting_.insert(old_page_id);
+            }
+            if (write_back)
+            {
+                // the flush thread did not keep up
+                num_foreground_writes_++;
+                if (flush_thread_ != nullptr)
+                {
+                    flush_cv_.notify_one();
+                }
             }
-            page->ResetMemory();
-            page->page_id_ = INVALID_PAGE_ID;
+        }
+
+        if (write_back)
+        {
+            beginWrite(page, old_page_id);
+        }
+        page->rec_lsn_ = INVALID_LSN;
+        page->page_id_ = page_id;
+        page->is_dirty_ = false;
+        page->is_loading_ = true;
+        // from here on hits may pin the frame, they see it loading
+        page->pin_count_ = 1;
+        if (page_id != INVALID_PAGE_ID)
+        {
+            page_table_->Insert(page_id, page);
         }
         return page;
     }
 
-} // namespace scudb
\ No newline at end of file
+/**
+ * Second half of installPage(): perform the disk I/O without holding the
+ * latch. Writes the old page back if needed, then either reads the new page
+ * from disk (read_page) or zeroes it and marks it dirty, since it is a brand
+ * new page. Waiters on the frame and on the evicted page are woken up.
+ */
+    void BufferPoolManager::finishInstall(unique_lock<mutex> &lock, Page *page,
+                                          page_id_t old_page_id,
+                                          bool write_back, bool read_page)
+    {
+        // a FlushPage() may still be writing the previous contents
+        while (page->is_flushing_)
+        {
+            page->io_cv_.wait(lock);
+        }
+        page_id_t page_id = page->page_id_;
+        lock.unlock();
+
+        if (write_back)
+        {
+            writePage(old_page_id, page->GetData());
+        }
+        page->ResetMemory();
+        if (read_page)
+        {
+            readPage(page_id, page->GetData());
+        }
+
+        lock.lock();
+        completeInstall(page, old_page_id, read_page);
+    }
+
+/**
+ * Bookkeeping once the I/O of an installed frame is done, with latch_ held
+ */
+    void BufferPoolManager::completeInstall(Page *page, page_id_t old_page_id,
+                                            bool read_page)
+    {
+        if (old_page_id != INVALID_PAGE_ID && evicting_.erase(old_page_id) > 0)
+        {
+            evict_cv_.notify_all();
+        }
+        page->write_page_id_ = INVALID_PAGE_ID;
+        page->write_rec_lsn_ = INVALID_LSN;
+        if (!read_page)
+        {
+            page->is_dirty_ = true;
+        }
+        page->is_loading_ = false;
+        page->io_cv_.notify_all();
+    }
+
+/**
+ * Counters and latency histograms of this pool, merged from the slots of all
+ * the threads that used it
+ */
+    BufferPoolStats BufferPoolManager::GetStats()
+    {
+        return stats_.Snapshot();
+    }
+
+/**
+ * Take latch_ and record how long that took. An uncontended latch is not
+ * timed at all, it counts as zero wait.
+ */
+    unique_lock<mutex> BufferPoolManager::lockLatch()
+    {
+        unique_lock<mutex> lock(latch_, try_to_lock);
+        if (lock.owns_lock())
+        {
+            stats_.Record(BufferPoolStatsCollector::LATCH_WAIT, 0);
+            return lock;
+        }
+        uint64_t start = BufferPoolStatsCollector::NowNanos();
+        lock.lock();
+        stats_.Record(BufferPoolStatsCollector::LATCH_WAIT,
+                      BufferPoolStatsCollector::NowNanos() - start);
+        return lock;
+    }
+
+/**
+ * Synchronous disk I/O of a frame, timed; the latch must not be held
+ */
+    void BufferPoolManager::readPage(page_id_t page_id, char *page_data)
+    {
+        uint64_t start = BufferPoolStatsCollector::NowNanos();
+        disk_manager_->ReadPage(page_id, page_data);
+        stats_.Record(BufferPoolStatsCollector::DISK_READ,
+                      BufferPoolStatsCollector::NowNanos() - start);
+    }
+
+    void BufferPoolManager::writePage(page_id_t page_id, const char *page_data)
+    {
+        forceLog(page_data);
+        uint64_t start = BufferPoolStatsCollector::NowNanos();
+        disk_manager_->WritePage(page_id, page_data);
+        stats_.Record(BufferPoolStatsCollector::DISK_WRITE,
+                      BufferPoolStatsCollector::NowNanos() - start);
+        stats_.Add(BufferPoolStatsCollector::DIRTY_WRITE_BACKS);
+    }
+
+/**
+ * Wait until the log records up to the LSN of the page (stored right after
+ * its page id, see page.h) are on disk, before the page itself is written.
+ * Mostly they are already, otherwise the wait joins the next group flush of
+ * the log manager, so the pages of a batch cost one log write at most. The
+ * latch must not be held.
+ */
+    void BufferPoolManager::forceLog(const char *page_data)
+    {
+        if (!ENABLE_LOGGING || log_manager_ == nullptr)
+        {
+            return;
+        }
+        lsn_t lsn;
+        memcpy(&lsn, page_data + 4, sizeof(lsn_t));
+        log_manager_->WaitForFlush(lsn);
+    }
+
+/*
+ * Must be called with latch_ held. Changes logged from now on set a new
+ * recLSN. A frame written again before the last write is done, e.g.
+ * evicted during a FlushPage(), keeps the older recLSN.
+ */
+    void BufferPoolManager::beginWrite(Page *page, page_id_t page_id)
+    {
+        lsn_t recLsn = page->rec_lsn_.exchange(INVALID_LSN);
+        if (page->write_rec_lsn_ == INVALID_LSN)
+        {
+            page->write_page_id_ = page_id;
+            page->write_rec_lsn_ = recLsn;
+        }
+    }
+
+/*
+ * Must be called with latch_ held. A frame installed for another page in
+ * the meantime still has to write the old one back, completeInstall() drops
+ * the recLSN then.
+ */
+    void BufferPoolManager::endWrite(Page *page)
+    {
+        if (page->is_loading_)
+        {
+            return;
+        }
+        page->write_page_id_ = INVALID_PAGE_ID;
+        page->write_rec_lsn_ = INVALID_LSN;
+    }
+
+} // namespace scudb
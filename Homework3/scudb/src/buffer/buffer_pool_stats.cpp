@@ -0,0 +1,152 @@
+#include <sstream>
+
+#include "buffer/buffer_pool_stats.h"
+
+namespace scudb {
+
+    int LatencyHistogram::BucketOf(uint64_t ns)
+    {
+        int bucket = 0;
+        while (ns > 1 && bucket < NUM_BUCKETS - 1)
+        {
+            ns >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+    void LatencyHistogram::Merge(const LatencyHistogram &other)
+    {
+        for (int i = 0; i < NUM_BUCKETS; ++i)
+        {
+            buckets[i] += other.buckets[i];
+        }
+        count += other.count;
+        total_ns += other.total_ns;
+    }
+
+    double LatencyHistogram::MeanNanos() const
+    {
+        return count == 0 ? 0 : static_cast<double>(total_ns) / count;
+    }
+
+    uint64_t LatencyHistogram::PercentileNanos(double fraction) const
+    {
+        uint64_t seen = 0;
+        for (int i = 0; i < NUM_BUCKETS; ++i)
+        {
+            seen += buckets[i];
+            if (seen > 0 && seen >= fraction * count)
+            {
+                return static_cast<uint64_t>(1) << (i + 1);
+            }
+        }
+        return 0;
+    }
+
+    double BufferPoolStats::HitRatio() const
+    {
+        uint64_t fetches = fetch_hits + fetch_misses;
+        return fetches == 0 ? 0 : static_cast<double>(fetch_hits) / fetches;
+    }
+
+    void BufferPoolStats::Merge(const BufferPoolStats &other)
+    {
+        fetch_hits += other.fetch_hits;
+        fetch_misses += other.fetch_misses;
+        evictions += other.evictions;
+        dirty_write_backs += other.dirty_write_backs;
+        new_page_failures += other.new_page_failures;
+        frame_wait_timeouts += other.frame_wait_timeouts;
+        latch_wait.Merge(other.latch_wait);
+        disk_read.Merge(other.disk_read);
+        disk_write.Merge(other.disk_write);
+        frame_wait.Merge(other.frame_wait);
+    }
+
+    std::string BufferPoolStats::ToString() const
+    {
+        std::stringstream out;
+        out << "hits: " << fetch_hits << " misses: " << fetch_misses
+            << " hit ratio: " << HitRatio() << " evictions: " << evictions
+            << " dirty write backs: " << dirty_write_backs
+            << " new page failures: " << new_page_failures
+            << " frame wait timeouts: " << frame_wait_timeouts;
+        const LatencyHistogram *histograms[] = {&latch_wait, &disk_read, &disk_write, &frame_wait};
+        const char *names[] = {"latch wait", "disk read", "disk write", "frame wait"};
+        for (int i = 0; i < 4; ++i)
+        {
+            out << "\n" << names[i] << ": count " << histograms[i]->count
+                << " mean " << histograms[i]->MeanNanos() << "ns p50 <"
+                << histograms[i]->PercentileNanos(0.5) << "ns p99 <"
+                << histograms[i]->PercentileNanos(0.99) << "ns";
+        }
+        return out.str();
+    }
+
+    BufferPoolStatsCollector::BufferPoolStatsCollector()
+    {
+        for (Slot &slot : slots_)
+        {
+            for (auto &counter : slot.counters)
+            {
+                counter.store(0, std::memory_order_relaxed);
+            }
+            for (int latency = 0; latency < NUM_LATENCIES; ++latency)
+            {
+                for (auto &bucket : slot.buckets[latency])
+                {
+                    bucket.store(0, std::memory_order_relaxed);
+                }
+                slot.totalNanos[latency].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void BufferPoolStatsCollector::Record(Latency latency, uint64_t ns)
+    {
+        Slot &slot = localSlot();
+        slot.buckets[latency][LatencyHistogram::BucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        slot.totalNanos[latency].fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    BufferPoolStats BufferPoolStatsCollector::Snapshot() const
+    {
+        BufferPoolStats stats;
+        LatencyHistogram *histograms[] = {&stats.latch_wait, &stats.disk_read, &stats.disk_write,
+                                          &stats.frame_wait};
+        for (const Slot &slot : slots_)
+        {
+            stats.fetch_hits += slot.counters[FETCH_HITS].load(std::memory_order_relaxed);
+            stats.fetch_misses += slot.counters[FETCH_MISSES].load(std::memory_order_relaxed);
+            stats.evictions += slot.counters[EVICTIONS].load(std::memory_order_relaxed);
+            stats.dirty_write_backs += slot.counters[DIRTY_WRITE_BACKS].load(std::memory_order_relaxed);
+            stats.new_page_failures += slot.counters[NEW_PAGE_FAILURES].load(std::memory_order_relaxed);
+            stats.frame_wait_timeouts += slot.counters[FRAME_WAIT_TIMEOUTS].load(std::memory_order_relaxed);
+            for (int latency = 0; latency < NUM_LATENCIES; ++latency)
+            {
+                LatencyHistogram *histogram = histograms[latency];
+                for (int i = 0; i < LatencyHistogram::NUM_BUCKETS; ++i)
+                {
+                    uint64_t n = slot.buckets[latency][i].load(std::memory_order_relaxed);
+                    histogram->buckets[i] += n;
+                    histogram->count += n;
+                }
+                histogram->total_ns += slot.totalNanos[latency].load(std::memory_order_relaxed);
+            }
+        }
+        return stats;
+    }
+
+/*
+ * Threads are numbered once, in the order they first record something, and
+ * keep using the slot of their number in every pool
+ */
+    BufferPoolStatsCollector::Slot &BufferPoolStatsCollector::localSlot()
+    {
+        static std::atomic<size_t> nextThread(0);
+        static thread_local size_t thread = nextThread.fetch_add(1);
+        return slots_[thread % BUFFER_POOL_STATS_SLOTS];
+    }
+
+} // namespace scudb
@@ -0,0 +1,197 @@
+/**
+ * CLOCK implementation
+ */
+#include <cassert>
+
+#include "buffer/clock_replacer.h"
+#include "page/page.h"
+
+namespace scudb {
+
+    template <typename T>
+    ClockReplacer<T>::ClockReplacer(size_t num_frames, std::function<size_t(const T &)> frame_index)
+            : frame_index_(frame_index), values_(num_frames),
+              present_(num_frames, 0), ref_bits_(num_frames) {}
+
+    template <typename T> ClockReplacer<T>::~ClockReplacer() {}
+
+/*
+ * Insert value into the clock, or give it a second chance if already there
+ */
+    template <typename T> void ClockReplacer<T>::Insert(const T &value)
+    {
+        size_t idx = frame_index_(value);
+        assert(idx < values_.size());
+        std::lock_guard<std::mutex> guard(latch_);
+        values_[idx] = value;
+        if (!present_[idx])
+        {
+            present_[idx] = 1;
+            size_++;
+        }
+        ref_bits_[idx].store(1, std::memory_order_relaxed);
+    }
+
+/*
+ * Give value a second chance without the latch, the hand reads the bit when
+ * it passes
+ */
+    template <typename T> void ClockReplacer<T>::RecordAccess(const T &value)
+    {
+        size_t idx = frame_index_(value);
+        assert(idx < values_.size());
+        ref_bits_[idx].store(1, std::memory_order_relaxed);
+    }
+
+/* Sweep the clock hand until a slot without reference bit is found, clearing
+ * reference bits on the way. Pop it to argument "value" and return true.
+ * If the clock is empty, return false
+ */
+    template <typename T> bool ClockReplacer<T>::Victim(T &value)
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        if (size_ == 0)
+        {
+            return false;
+        }
+        // two rounds, the first one may only clear reference bits
+        for (size_t step = 0; step < 2 * values_.size(); ++step)
+        {
+            size_t idx = hand_;
+            hand_ = (hand_ + 1) % values_.size();
+            if (!present_[idx])
+            {
+                continue;
+            }
+            if (ref_bits_[idx].exchange(0, std::memory_order_relaxed))
+            {
+                continue;
+            }
+            present_[idx] = 0;
+            size_--;
+            value = values_[idx];
+            return true;
+        }
+        value = values_[popNextPresent()];
+        return true;
+    }
+
+/* Same sweep as Victim, but unreferenced slots that do not satisfy prefer are
+ * passed over. Once the hand has gone round twice, so that every reference bit
+ * has been cleared, the first slot passed over is taken instead, or the next
+ * one if hits set every bit again behind the hand
+ */
+    template <typename T>
+    bool ClockReplacer<T>::VictimPreferring(T &value, const std::function<bool(const T &)> &prefer)
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        if (size_ == 0)
+        {
+            return false;
+        }
+        size_t fallback = values_.size();
+        for (size_t step = 0; step < 2 * values_.size(); ++step)
+        {
+            size_t idx = hand_;
+            hand_ = (hand_ + 1) % values_.size();
+            if (!present_[idx])
+            {
+                continue;
+            }
+            if (ref_bits_[idx].exchange(0, std::memory_order_relaxed))
+            {
+                continue;
+            }
+            if (prefer(values_[idx]))
+            {
+                fallback = idx;
+                break;
+            }
+            if (fallback == values_.size())
+            {
+                fallback = idx;
+            }
+        }
+        if (fallback == values_.size())
+        {
+            value = values_[popNextPresent()];
+            return true;
+        }
+        present_[fallback] = 0;
+        size_--;
+        value = values_[fallback];
+        return true;
+    }
+
+/*
+ * RecordAccess() runs without the latch, so hits may set the reference bits
+ * again as fast as the hand clears them. Then the sweep ends without a
+ * victim, and the slot at the hand goes regardless of its bit. The clock
+ * must not be empty
+ */
+    template <typename T> size_t ClockReplacer<T>::popNextPresent()
+    {
+        while (!present_[hand_])
+        {
+            hand_ = (hand_ + 1) % values_.size();
+        }
+        size_t idx = hand_;
+        hand_ = (hand_ + 1) % values_.size();
+        present_[idx] = 0;
+        size_--;
+        return idx;
+    }
+
+/*
+ * Remove value from the clock. If removal is successful, return true,
+ * otherwise return false
+ */
+    template <typename T> bool ClockReplacer<T>::Erase(const T &value)
+    {
+        size_t idx = frame_index_(value);
+        assert(idx < values_.size());
+        std::lock_guard<std::mutex> guard(latch_);
+        if (!present_[idx])
+        {
+            return false;
+        }
+        present_[idx] = 0;
+        size_--;
+        return true;
+    }
+
+    template <typename T> size_t ClockReplacer<T>::Size()
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        return size_;
+    }
+
+/*
+ * Referenced slots survive the next sweep, so they come first; within each
+ * group the slots are taken from behind the hand backwards, which is the
+ * reverse of the order the hand reaches them
+ */
+    template <typename T> std::vector<T> ClockReplacer<T>::HotnessOrder()
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        std::vector<T> order;
+        for (char referenced : {1, 0})
+        {
+            for (size_t step = 1; step <= values_.size(); ++step)
+            {
+                size_t idx = (hand_ + values_.size() - step) % values_.size();
+                if (present_[idx] &&
+                    ref_bits_[idx].load(std::memory_order_relaxed) == referenced)
+                {
+                    order.push_back(values_[idx]);
+                }
+            }
+        }
+        return order;
+    }
+
+    template class ClockReplacer<Page *>;
+// test only
+    template class ClockReplacer<int>;
+
+} // namespace scudb
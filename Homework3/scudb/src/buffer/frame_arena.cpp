@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <sys/mman.h>
+
+#include "buffer/frame_arena.h"
+
+namespace scudb {
+
+    // size of a (x86-64) huge page, smaller arenas stay on regular pages
+    static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+/*
+ * Map room for num_frames pages of page_size bytes. Reserved huge pages are
+ * tried first; without them the mapping is aligned to the huge page size and
+ * transparent huge pages are requested, which the kernel may or may not
+ * grant. throws std::bad_alloc if there is no memory at all
+ */
+    FrameArena::FrameArena(size_t num_frames, int page_size)
+            : mapping_(nullptr), length_(0), data_(nullptr),
+              page_size_(page_size), huge_pages_(false)
+    {
+        size_t size = std::max<size_t>(num_frames, 1) * page_size_;
+        void *mapping = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        if (size >= HUGE_PAGE_SIZE)
+        {
+            length_ = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+            mapping = mmap(nullptr, length_, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            huge_pages_ = mapping != MAP_FAILED;
+        }
+#endif
+        size_t alignment = size >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : page_size_;
+        if (mapping == MAP_FAILED)
+        {
+            // regular pages are only aligned to the system page size
+            length_ = size + alignment;
+            mapping = mmap(nullptr, length_, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mapping == MAP_FAILED)
+            {
+                throw std::bad_alloc();
+            }
+        }
+        mapping_ = static_cast<char *>(mapping);
+        uintptr_t start = reinterpret_cast<uintptr_t>(mapping_);
+        data_ = mapping_ + (alignment - start % alignment) % alignment;
+#ifdef MADV_HUGEPAGE
+        if (!huge_pages_ && size >= HUGE_PAGE_SIZE)
+        {
+            madvise(data_, size, MADV_HUGEPAGE);
+        }
+#endif
+    }
+
+    FrameArena::~FrameArena()
+    {
+        munmap(mapping_, length_);
+    }
+
+} // namespace scudb
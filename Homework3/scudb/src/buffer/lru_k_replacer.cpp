@@ -0,0 +1,206 @@
+/**
+ * LRU-K implementation
+ */
+#include <algorithm>
+#include <cassert>
+
+#include "buffer/lru_k_replacer.h"
+#include "page/page.h"
+
+namespace scudb {
+
+    template <typename T>
+    LRUKReplacer<T>::LRUKReplacer(size_t num_frames, std::function<size_t(const T &)> frame_index,
+                                  size_t k)
+            : frame_index_(frame_index), k_(k), values_(num_frames),
+              present_(num_frames, 0), history_(num_frames * k),
+              num_accesses_(num_frames)
+    {
+        assert(k_ > 0);
+    }
+
+    template <typename T> LRUKReplacer<T>::~LRUKReplacer() {}
+
+/*
+ * Remember the current timestamp as the latest access of value. No latch is
+ * taken: the slot of the ring is claimed by counting the access, then filled
+ * in. A victim search in between may see the count before the timestamp, and
+ * two concurrent accesses of one value may fill in their slots out of order;
+ * either only shifts the distance of value by a few accesses
+ */
+    template <typename T> void LRUKReplacer<T>::RecordAccess(const T &value)
+    {
+        size_t idx = frame_index_(value);
+        assert(idx < values_.size());
+        size_t timestamp = current_timestamp_.fetch_add(1, std::memory_order_relaxed) + 1;
+        size_t accesses = num_accesses_[idx].fetch_add(1, std::memory_order_relaxed);
+        history_[idx * k_ + accesses % k_].store(timestamp, std::memory_order_relaxed);
+    }
+
+/*
+ * Make value a candidate for eviction
+ */
+    template <typename T> void LRUKReplacer<T>::Insert(const T &value)
+    {
+        size_t idx = frame_index_(value);
+        assert(idx < values_.size());
+        std::lock_guard<std::mutex> guard(latch_);
+        values_[idx] = value;
+        if (!present_[idx])
+        {
+            present_[idx] = 1;
+            size_++;
+        }
+    }
+
+/* Pop the candidate with the largest backward K-distance to argument "value"
+ * and forget its history, since the frame is about to hold another page.
+ * return false if there is no candidate
+ */
+    template <typename T> bool LRUKReplacer<T>::Victim(T &value)
+    {
+        return victim(value, nullptr);
+    }
+
+/*
+ * Same as Victim, but within the candidates of infinite distance, or if there
+ * are none within those of finite distance, one satisfying prefer wins. Pages
+ * used k times are never traded for a preferred one used fewer times.
+ */
+    template <typename T>
+    bool LRUKReplacer<T>::VictimPreferring(T &value, const std::function<bool(const T &)> &prefer)
+    {
+        return victim(value, &prefer);
+    }
+
+    template <typename T>
+    bool LRUKReplacer<T>::victim(T &value, const std::function<bool(const T &)> *prefer)
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        if (size_ == 0)
+        {
+            return false;
+        }
+
+        size_t victim = values_.size();
+        bool victimPreferred = false;
+        bool victimInfinite = false;
+        size_t victimTimestamp = 0;
+        for (size_t idx = 0; idx < values_.size(); ++idx)
+        {
+            if (!present_[idx])
+            {
+                continue;
+            }
+            bool preferred = prefer != nullptr && (*prefer)(values_[idx]);
+            bool infinite = num_accesses_[idx].load(std::memory_order_relaxed) < k_;
+            size_t timestamp = distanceTimestamp(idx);
+            if (victim == values_.size() || (infinite && !victimInfinite) ||
+                (infinite == victimInfinite &&
+                 ((preferred && !victimPreferred) ||
+                  (preferred == victimPreferred && timestamp < victimTimestamp))))
+            {
+                victim = idx;
+                victimPreferred = preferred;
+                victimInfinite = infinite;
+                victimTimestamp = timestamp;
+            }
+        }
+
+        present_[victim] = 0;
+        num_accesses_[victim].store(0, std::memory_order_relaxed);
+        size_--;
+        value = values_[victim];
+        return true;
+    }
+
+/*
+ * Candidates of finite distance first, then those of infinite distance; each
+ * group by its compared access timestamp, newest first
+ */
+    template <typename T> std::vector<T> LRUKReplacer<T>::HotnessOrder()
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        std::vector<std::pair<std::pair<bool, size_t>, size_t>> keys;
+        for (size_t idx = 0; idx < values_.size(); ++idx)
+        {
+            if (present_[idx])
+            {
+                // ascending order of (infinite, -timestamp)
+                bool infinite = num_accesses_[idx].load(std::memory_order_relaxed) < k_;
+                keys.push_back({{infinite, ~distanceTimestamp(idx)}, idx});
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+        std::vector<T> order;
+        for (auto &key : keys)
+        {
+            order.push_back(values_[key.second]);
+        }
+        return order;
+    }
+
+/*
+ * helper: the access whose age is the backward K-distance of slot idx. For
+ * infinite distance it is the first access, otherwise the k-th most recent
+ * one; both are the oldest entry in the ring. latch_ must be held
+ */
+    template <typename T> size_t LRUKReplacer<T>::distanceTimestamp(size_t idx)
+    {
+        size_t accesses = num_accesses_[idx].load(std::memory_order_relaxed);
+        if (accesses == 0)
+        {
+            return 0;
+        }
+        bool infinite = accesses < k_;
+        return history_[idx * k_ + (infinite ? 0 : accesses % k_)].load(std::memory_order_relaxed);
+    }
+
+/*
+ * Remove value from the candidates, its history is kept. If removal is
+ * successful, return true, otherwise return false
+ */
+    template <typename T> bool LRUKReplacer<T>::Erase(const T &value)
+    {
+        size_t idx = frame_index_(value);
+        assert(idx < values_.size());
+        std::lock_guard<std::mutex> guard(latch_);
+        if (!present_[idx])
+        {
+            return false;
+        }
+        present_[idx] = 0;
+        size_--;
+        return true;
+    }
+
+/*
+ * Same as Erase, but also forget the history of value, because its frame is
+ * given to another page. The frame does not have to be a candidate
+ */
+    template <typename T> bool LRUKReplacer<T>::Remove(const T &value)
+    {
+        size_t idx = frame_index_(value);
+        assert(idx < values_.size());
+        std::lock_guard<std::mutex> guard(latch_);
+        num_accesses_[idx].store(0, std::memory_order_relaxed);
+        if (!present_[idx])
+        {
+            return false;
+        }
+        present_[idx] = 0;
+        size_--;
+        return true;
+    }
+
+    template <typename T> size_t LRUKReplacer<T>::Size()
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        return size_;
+    }
+
+    template class LRUKReplacer<Page *>;
+// test only
+    template class LRUKReplacer<int>;
+
+} // namespace scudb
@@ -95,6 +95,33 @@ namespace scudb {
         }
     }
 
+/*
+ * Walk the older half of the list from the least recently used end and pop
+ * the first value satisfying prefer; if there is none, behave like Victim.
+ * Recently used values are never traded for a preferred one.
+ */
+    template <typename T>
+    bool LRUReplacer<T>::VictimPreferring(T &value, const std::function<bool(const T &)> &prefer)
+    {
+        lock_guard<std::mutex> guard(latch);
+
+        int window = (size + 1) / 2;
+        for (auto node = tail; node != nullptr && window > 0; node = node->pre, --window)
+        {
+            if (prefer(node->value))
+            {
+                value = node->value;
+                return erase(value);
+            }
+        }
+        if (tail == nullptr)
+        {
+            return false;
+        }
+        value = tail->value;
+        return erase(value);
+    }
+
 /*
  * Remove value from LRU. If removal is successful, return true, otherwise
  * return false
@@ -111,6 +138,20 @@ namespace scudb {
         return size;
     }
 
+/*
+ * From the most recently used end of the list to the least recently used one
+ */
+    template <typename T> std::vector<T> LRUReplacer<T>::HotnessOrder()
+    {
+        lock_guard<mutex> guard(latch);
+        std::vector<T> order;
+        for (auto node = head; node != nullptr; node = node->next)
+        {
+            order.push_back(node->value);
+        }
+        return order;
+    }
+
     template <typename T> bool LRUReplacer<T>::erase(const T &value)
     {
         auto iter = index.find(value);
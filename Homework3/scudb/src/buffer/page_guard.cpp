@@ -0,0 +1,100 @@
+#include <utility>
+
+#include "buffer/page_guard.h"
+#include "buffer/buffer_pool_manager.h"
+
+namespace scudb {
+
+    BasicPageGuard::BasicPageGuard(BufferPoolManager *bufferPoolManager, Page *page)
+            : buffer_pool_manager_(bufferPoolManager), page_(page) {}
+
+    BasicPageGuard::BasicPageGuard(BasicPageGuard &&other)
+            : buffer_pool_manager_(other.buffer_pool_manager_), page_(other.page_),
+              is_dirty_(other.is_dirty_)
+    {
+        other.page_ = nullptr;
+    }
+
+/*
+ * The page held so far is released before the other one is taken over
+ */
+    BasicPageGuard &BasicPageGuard::operator=(BasicPageGuard &&other)
+    {
+        if (this != &other)
+        {
+            Drop();
+            buffer_pool_manager_ = other.buffer_pool_manager_;
+            page_ = other.page_;
+            is_dirty_ = other.is_dirty_;
+            other.page_ = nullptr;
+        }
+        return *this;
+    }
+
+    void BasicPageGuard::Drop()
+    {
+        if (page_ != nullptr)
+        {
+            buffer_pool_manager_->UnpinPage(page_->GetPageId(), is_dirty_);
+            page_ = nullptr;
+        }
+        is_dirty_ = false;
+    }
+
+    ReadPageGuard::ReadPageGuard(BufferPoolManager *bufferPoolManager, Page *page)
+            : guard_(bufferPoolManager, page)
+    {
+        if (page != nullptr)
+        {
+            page->RLatch();
+        }
+    }
+
+    ReadPageGuard &ReadPageGuard::operator=(ReadPageGuard &&other)
+    {
+        if (this != &other)
+        {
+            Drop();
+            guard_ = std::move(other.guard_);
+        }
+        return *this;
+    }
+
+    void ReadPageGuard::Drop()
+    {
+        if (guard_)
+        {
+            guard_.GetPage()->RUnlatch();
+        }
+        guard_.Drop();
+    }
+
+    WritePageGuard::WritePageGuard(BufferPoolManager *bufferPoolManager, Page *page)
+            : guard_(bufferPoolManager, page)
+    {
+        if (page != nullptr)
+        {
+            page->WLatch();
+        }
+    }
+
+    WritePageGuard &WritePageGuard::operator=(WritePageGuard &&other)
+    {
+        if (this != &other)
+        {
+            Drop();
+            guard_ = std::move(other.guard_);
+        }
+        return *this;
+    }
+
+    void WritePageGuard::Drop()
+    {
+        if (guard_)
+        {
+            guard_.GetPage()->WUnlatch();
+        }
+        guard_.Drop();
+    }
+
+} // namespace scudb
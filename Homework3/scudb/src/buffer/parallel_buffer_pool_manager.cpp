@@ -0,0 +1,307 @@
+#include <algorithm>
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+using namespace std;
+
+namespace scudb {
+
+/*
+ * ParallelBufferPoolManager Constructor
+ * the first (pool_size % num_instances) instances get one extra frame
+ */
+    ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances,
+                                                         size_t pool_size,
+                                                         DiskManager *disk_manager,
+                                                         LogManager *log_manager,
+                                                         ReplacerType replacer_type)
+            : BufferPoolManager(disk_manager, log_manager),
+              total_pool_size_(pool_size)
+    {
+        assert(num_instances > 0 && num_instances <= pool_size);
+        for (size_t i = 0; i < num_instances; ++i)
+        {
+            size_t size = pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0);
+            instances_.push_back(new BufferPoolManager(size, disk_manager, log_manager, replacer_type));
+            // one trace for the whole pool
+            instances_.back()->trace_ = trace_;
+        }
+    }
+
+    ParallelBufferPoolManager::~ParallelBufferPoolManager()
+    {
+        for (auto instance : instances_)
+        {
+            delete instance;
+        }
+    }
+
+/*
+ * the instance responsible for page_id
+ */
+    BufferPoolManager *ParallelBufferPoolManager::getInstance(page_id_t page_id)
+    {
+        assert(page_id != INVALID_PAGE_ID);
+        return instances_[static_cast<size_t>(page_id) % instances_.size()];
+    }
+
+    Page *ParallelBufferPoolManager::FetchPage(page_id_t page_id, AccessStrategy strategy)
+    {
+        return getInstance(page_id)->FetchPage(page_id, strategy);
+    }
+
+    bool ParallelBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty)
+    {
+        return getInstance(page_id)->UnpinPage(page_id, is_dirty);
+    }
+
+    bool ParallelBufferPoolManager::FlushPage(page_id_t page_id)
+    {
+        return getInstance(page_id)->FlushPage(page_id);
+    }
+
+/*
+ * consecutive pages live in different instances, so the dirty frames of all
+ * instances are written as one batch for the runs to span them
+ */
+    void ParallelBufferPoolManager::FlushAllPages()
+    {
+        vector<vector<pair<page_id_t, Page *>>> perInstance(instances_.size());
+        vector<pair<page_id_t, Page *>> frames;
+        for (size_t i = 0; i < instances_.size(); ++i)
+        {
+            instances_[i]->beginFlushAll(perInstance[i]);
+            frames.insert(frames.end(), perInstance[i].begin(), perInstance[i].end());
+        }
+        writeFlushAll(frames);
+        for (size_t i = 0; i < instances_.size(); ++i)
+        {
+            instances_[i]->endFlushAll(perInstance[i]);
+        }
+        disk_manager_->SyncPages();
+    }
+
+    bool ParallelBufferPoolManager::DeletePage(page_id_t page_id)
+    {
+        return getInstance(page_id)->DeletePage(page_id);
+    }
+
+/*
+ * every instance runs its own flush thread
+ */
+    void ParallelBufferPoolManager::RunFlushThread(double clean_ratio)
+    {
+        for (auto instance : instances_)
+        {
+            instance->RunFlushThread(clean_ratio);
+        }
+    }
+
+    void ParallelBufferPoolManager::StopFlushThread()
+    {
+        for (auto instance : instances_)
+        {
+            instance->StopFlushThread();
+        }
+    }
+
+    size_t ParallelBufferPoolManager::GetNumForegroundWrites()
+    {
+        size_t writes = 0;
+        for (auto instance : instances_)
+        {
+            writes += instance->GetNumForegroundWrites();
+        }
+        return writes;
+    }
+
+    size_t ParallelBufferPoolManager::GetNumBackgroundWrites()
+    {
+        size_t writes = 0;
+        for (auto instance : instances_)
+        {
+            writes += instance->GetNumBackgroundWrites();
+        }
+        return writes;
+    }
+
+/*
+ * merge the statistics of all instances; NewPage failures are only counted
+ * once, by this pool
+ */
+    size_t ParallelBufferPoolManager::GetRingSize()
+    {
+        size_t ringSize = instances_[0]->GetRingSize();
+        for (auto instance : instances_)
+        {
+            ringSize = min(ringSize, instance->GetRingSize());
+        }
+        return ringSize * instances_.size();
+    }
+
+    BufferPoolStats ParallelBufferPoolManager::GetStats()
+    {
+        BufferPoolStats stats = stats_.Snapshot();
+        for (auto instance : instances_)
+        {
+            stats.Merge(instance->GetStats());
+        }
+        return stats;
+    }
+
+/*
+ * every instance queues its own waiters, this pool only needs the timeout to
+ * know whether NewPage should wait
+ */
+    void ParallelBufferPoolManager::SetFrameWaitTimeout(chrono::milliseconds timeout)
+    {
+        BufferPoolManager::SetFrameWaitTimeout(timeout);
+        for (auto instance : instances_)
+        {
+            instance->SetFrameWaitTimeout(timeout);
+        }
+    }
+
+    void ParallelBufferPoolManager::GetDirtyPageTable(vector<pair<page_id_t, lsn_t>> &dirty_pages)
+    {
+        for (auto instance : instances_)
+        {
+            instance->GetDirtyPageTable(dirty_pages);
+        }
+    }
+
+/*
+ * split the requests by instance, each instance prefetches its own pages
+ */
+    void ParallelBufferPoolManager::PrefetchPages(const vector<page_id_t> &page_ids,
+                                                  AccessStrategy strategy)
+    {
+        vector<vector<page_id_t>> perInstance(instances_.size());
+        for (page_id_t page_id : page_ids)
+        {
+            perInstance[static_cast<size_t>(page_id) % instances_.size()].push_back(page_id);
+        }
+        for (size_t i = 0; i < instances_.size(); ++i)
+        {
+            if (!perInstance[i].empty())
+            {
+                instances_[i]->PrefetchPages(perInstance[i], strategy);
+            }
+        }
+    }
+
+/*
+ * one list for the whole pool: the lists of the instances are interleaved,
+ * the hottest page of every instance first, then the second hottest, ...
+ */
+    void ParallelBufferPoolManager::SaveWarmupList()
+    {
+        vector<vector<page_id_t>> perInstance;
+        size_t longest = 0;
+        for (auto instance : instances_)
+        {
+            perInstance.push_back(instance->residentPages());
+            longest = max(longest, perInstance.back().size());
+        }
+        vector<page_id_t> pageIds;
+        for (size_t rank = 0; rank < longest; ++rank)
+        {
+            for (auto &pages : perInstance)
+            {
+                if (rank < pages.size())
+                {
+                    pageIds.push_back(pages[rank]);
+                }
+            }
+        }
+        disk_manager_->WriteWarmupList(pageIds);
+    }
+
+/*
+ * split the list by instance, keeping its order, and warm up all instances
+ * at the same time
+ */
+    size_t ParallelBufferPoolManager::WarmUp(bool wait)
+    {
+        vector<vector<page_id_t>> perInstance(instances_.size());
+        for (page_id_t page_id : disk_manager_->ReadWarmupList())
+        {
+            perInstance[static_cast<size_t>(page_id) % instances_.size()].push_back(page_id);
+        }
+        size_t numQueued = 0;
+        for (size_t i = 0; i < instances_.size(); ++i)
+        {
+            numQueued += instances_[i]->queueWarmup(perInstance[i]);
+        }
+        if (wait)
+        {
+            for (auto instance : instances_)
+            {
+                instance->waitForPrefetch();
+            }
+        }
+        return numQueued;
+    }
+
+/**
+ * Allocate a page id and hand it to the instance it hashes onto. Ids that did
+ * not fit are held until every instance has been tried, otherwise the disk
+ * manager would hand out the same id again, and released at the end. Ids
+ * past the end of the file are consecutive and hash onto consecutive
+ * instances, so this terminates. Only if every instance is full, one more id
+ * waits for a frame in its instance, see SetFrameWaitTimeout(). return
+ * nullptr if all the pages in every instance are pinned
+ */
+    Page *ParallelBufferPoolManager::NewPage(page_id_t &page_id)
+    {
+        vector<bool> tried(instances_.size(), false);
+        size_t numTried = 0;
+        vector<page_id_t> heldPageIds;
+        Page *newPage = nullptr;
+        while (numTried < instances_.size())
+        {
+            page_id_t newPageId = disk_manager_->AllocatePage();
+            size_t instance = static_cast<size_t>(newPageId) % instances_.size();
+            if (!tried[instance])
+            {
+                tried[instance] = true;
+                numTried++;
+                newPage = instances_[instance]->newPageWithId(newPageId, false);
+                if (newPage != nullptr)
+                {
+                    page_id = newPageId;
+                    break;
+                }
+            }
+            heldPageIds.push_back(newPageId);
+        }
+        bool wait;
+        {
+            lock_guard<mutex> guard(latch_);
+            wait = frame_wait_timeout_.count() > 0;
+        }
+        if (newPage == nullptr && wait)
+        {
+            page_id_t newPageId = disk_manager_->AllocatePage();
+            newPage = getInstance(newPageId)->newPageWithId(newPageId, true);
+            if (newPage != nullptr)
+            {
+                page_id = newPageId;
+            }
+            else
+            {
+                heldPageIds.push_back(newPageId);
+            }
+        }
+        for (page_id_t heldPageId : heldPageIds)
+        {
+            disk_manager_->DeallocatePage(heldPageId);
+        }
+        if (newPage == nullptr)
+        {
+            stats_.Add(BufferPoolStatsCollector::NEW_PAGE_FAILURES);
+        }
+        return newPage;
+    }
+
+} // namespace scudb
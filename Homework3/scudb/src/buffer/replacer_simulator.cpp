@@ -0,0 +1,103 @@
+#include <deque>
+#include <memory>
+#include <unordered_map>
+
+#include "buffer/replacer_simulator.h"
+
+namespace scudb {
+
+/*
+ * The frames are managed like BufferPoolManager does: a fetch or a new page
+ * pins the frame and records an access, an unpin to zero makes it a victim
+ * candidate again, a delete frees it. Free frames are used before a victim,
+ * in the order they were freed.
+ */
+    SimulationResult SimulateTrace(const std::vector<TraceRecord> &trace,
+                                   size_t pool_size, Replacer<int> &replacer)
+    {
+        SimulationResult result;
+        result.poolSize = pool_size;
+        std::unordered_map<page_id_t, int> frameOf;
+        std::vector<page_id_t> pageOf(pool_size, INVALID_PAGE_ID);
+        std::vector<int> pins(pool_size, 0);
+        std::deque<int> freeFrames;
+        for (size_t i = 0; i < pool_size; ++i)
+        {
+            freeFrames.push_back(static_cast<int>(i));
+        }
+
+        for (const TraceRecord &record : trace)
+        {
+            auto iter = frameOf.find(record.pageId);
+            bool resident = iter != frameOf.end();
+            int frame = resident ? iter->second : -1;
+            switch (record.op)
+            {
+                case TraceOp::FETCH:
+                case TraceOp::NEW:
+                    if (record.op == TraceOp::FETCH)
+                    {
+                        result.fetches++;
+                        result.misses += !resident;
+                    }
+                    if (!resident)
+                    {
+                        if (!freeFrames.empty())
+                        {
+                            frame = freeFrames.front();
+                            freeFrames.pop_front();
+                        }
+                        else if (replacer.Victim(frame))
+                        {
+                            frameOf.erase(pageOf[frame]);
+                        }
+                        else
+                        {
+                            result.failures++;
+                            break;
+                        }
+                        frameOf[record.pageId] = frame;
+                        pageOf[frame] = record.pageId;
+                    }
+                    else if (pins[frame] == 0)
+                    {
+                        replacer.Erase(frame);
+                    }
+                    pins[frame]++;
+                    replacer.RecordAccess(frame);
+                    break;
+                case TraceOp::UNPIN:
+                    if (resident && pins[frame] > 0 && --pins[frame] == 0)
+                    {
+                        replacer.Insert(frame);
+                    }
+                    break;
+                case TraceOp::DELETE:
+                    if (resident && pins[frame] == 0)
+                    {
+                        replacer.Remove(frame);
+                        frameOf.erase(iter);
+                        pageOf[frame] = INVALID_PAGE_ID;
+                        freeFrames.push_back(frame);
+                    }
+                    break;
+            }
+        }
+        return result;
+    }
+
+    std::vector<SimulationResult> MissRatioCurve(
+            const std::vector<TraceRecord> &trace,
+            const std::vector<size_t> &pool_sizes,
+            const std::function<Replacer<int> *(size_t pool_size)> &make_replacer)
+    {
+        std::vector<SimulationResult> curve;
+        for (size_t poolSize : pool_sizes)
+        {
+            std::unique_ptr<Replacer<int>> replacer(make_replacer(poolSize));
+            curve.push_back(SimulateTrace(trace, poolSize, *replacer));
+        }
+        return curve;
+    }
+
+} // namespace scudb
@@ -4,4 +4,8 @@ namespace scudb {
   std::atomic<bool> ENABLE_LOGGING(false);  // for virtual table
   std::chrono::duration<long long int> LOG_TIMEOUT =
    std::chrono::seconds(1);
+  std::chrono::milliseconds BUFFER_POOL_FLUSH_TIMEOUT =
+   std::chrono::milliseconds(100);
+  std::chrono::milliseconds CHECKPOINT_TIMEOUT =
+   std::chrono::seconds(30);
 }
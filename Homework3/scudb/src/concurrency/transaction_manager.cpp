@@ -12,7 +12,14 @@ Transaction *TransactionManager::Begin() {
   Transaction *txn = new Transaction(next_txn_id_++);
 
   if (ENABLE_LOGGING) {
-    // TODO: write log and update transaction's prev_lsn here
+    // a checkpoint that starts after the BEGIN record is appended finds
+    // the transaction
+    std::lock_guard<std::mutex> guard(latch_);
+    LogRecord log_record(txn->GetTransactionId(), INVALID_LSN,
+                         LogRecordType::BEGIN);
+    lsn_t lsn = log_manager_->AppendLogRecord(log_record);
+    txn->SetPrevLSN(lsn);
+    active_txns_[txn->GetTransactionId()] = std::make_pair(txn, lsn);
   }
 
   return txn;
@@ -34,8 +41,15 @@ void TransactionManager::Commit(Transaction *txn) {
   write_set->clear();
 
   if (ENABLE_LOGGING) {
-    // TODO: write log and update transaction's prev_lsn here
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
+                         LogRecordType::COMMIT);
+    lsn_t lsn = log_manager_->AppendLogRecord(log_record);
+    txn->SetPrevLSN(lsn);
+    // the commit is durable once its record is; the flush thread writes
+    // the records of every transaction committing meanwhile in one go
+    log_manager_->WaitForFlush(lsn);
   }
+  EndTransaction(txn);
 
   // release all the lock
   std::unordered_set<RID> lock_set;
@@ -71,8 +85,11 @@ void TransactionManager::Abort(Transaction *txn) {
   write_set->clear();
 
   if (ENABLE_LOGGING) {
-    // TODO: write log and update transaction's prev_lsn here
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
+                         LogRecordType::ABORT);
+    txn->SetPrevLSN(log_manager_->AppendLogRecord(log_record));
   }
+  EndTransaction(txn);
 
   // release all the lock
   std::unordered_set<RID> lock_set;
@@ -85,4 +102,26 @@ void TransactionManager::Abort(Transaction *txn) {
     lock_manager_->Unlock(txn, locked_rid);
   }
 }
+
+void TransactionManager::GetActiveTransactions(
+    std::vector<std::pair<txn_id_t, lsn_t>> &active_txns,
+    lsn_t &oldest_begin_lsn) {
+  std::lock_guard<std::mutex> guard(latch_);
+  oldest_begin_lsn = INVALID_LSN;
+  for (auto &entry : active_txns_) {
+    active_txns.emplace_back(entry.first, entry.second.first->GetPrevLSN());
+    if (oldest_begin_lsn == INVALID_LSN ||
+        entry.second.second < oldest_begin_lsn) {
+      oldest_begin_lsn = entry.second.second;
+    }
+  }
+}
+
+/*
+ * the transaction stays known until its COMMIT/ABORT record is appended
+ */
+void TransactionManager::EndTransaction(Transaction *txn) {
+  std::lock_guard<std::mutex> guard(latch_);
+  active_txns_.erase(txn->GetTransactionId());
+}
 } // namespace scudb
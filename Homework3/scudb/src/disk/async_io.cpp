@@ -0,0 +1,265 @@
+/**
+ * async_io.cpp
+ */
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "common/logger.h"
+#include "disk/async_io.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace scudb {
+
+struct AsyncIO::Request {
+  bool write;
+  int fd;
+  char *data;
+  size_t size;
+  off_t offset;
+  struct iovec iov;
+  Callback done;
+};
+
+/**
+ * Private helper: move the rest of the request synchronously, starting after
+ * the first done bytes. Returns the total number of bytes transferred, less
+ * than size only at the end of file, or -errno on error.
+ */
+static int Transfer(int fd, bool write, char *data, size_t size, off_t offset,
+                    size_t done) {
+  while (done < size) {
+    ssize_t rc = write ? pwrite(fd, data + done, size - done, offset + done)
+                       : pread(fd, data + done, size - done, offset + done);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc < 0) {
+      return -errno;
+    }
+    if (rc == 0) {
+      break;
+    }
+    done += rc;
+  }
+  return static_cast<int>(done);
+}
+
+AsyncIO::AsyncIO(unsigned entries) {
+#ifdef HAVE_IO_URING
+  Setup(entries);
+#endif
+  if (ring_fd_ < 0) {
+    LOG_DEBUG("io_uring not available, using synchronous I/O");
+  }
+}
+
+AsyncIO::~AsyncIO() {
+#ifdef HAVE_IO_URING
+  if (ring_fd_ < 0) {
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (in_flight_ > 0) {
+      slot_cv_.wait(lock);
+    }
+  }
+  // a request without user data stops the reaper
+  Submit(nullptr);
+  reap_thread_->join();
+  delete reap_thread_;
+  munmap(sqes_, sqes_size_);
+  if (cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  munmap(sq_ring_, sq_ring_size_);
+  close(ring_fd_);
+#endif
+}
+
+void AsyncIO::Read(int fd, char *data, size_t size, off_t offset,
+                   Callback done) {
+  Submit(new Request{false, fd, data, size, offset, {}, std::move(done)});
+}
+
+void AsyncIO::Write(int fd, const char *data, size_t size, off_t offset,
+                    Callback done) {
+  Submit(new Request{true, fd, const_cast<char *>(data), size, offset, {},
+                     std::move(done)});
+}
+
+/**
+ * Private helper: create the ring and map its queues, leaves ring_fd_ at -1
+ * if the kernel refuses
+ */
+void AsyncIO::Setup(unsigned entries) {
+#ifdef HAVE_IO_URING
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int fd = syscall(__NR_io_uring_setup, entries, &params);
+  if (fd < 0) {
+    return;
+  }
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    close(fd);
+    return;
+  }
+  cq_ring_ = single_mmap
+                 ? sq_ring_
+                 : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+  sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (cq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sqes_ != MAP_FAILED) {
+      munmap(sqes_, sqes_size_);
+    }
+    munmap(sq_ring_, sq_ring_size_);
+    close(fd);
+    return;
+  }
+
+  char *sq = static_cast<char *>(sq_ring_);
+  char *cq = static_cast<char *>(cq_ring_);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+  entries_ = params.sq_entries;
+  ring_fd_ = fd;
+  reap_thread_ = new std::thread(&AsyncIO::ReapThread, this);
+#endif
+}
+
+/**
+ * Private helper: queue one request and hand it to the kernel, waiting for a
+ * free slot first. Without a ring the request is executed right away.
+ */
+void AsyncIO::Submit(Request *request) {
+  if (ring_fd_ < 0) {
+    Complete(request, 0);
+    return;
+  }
+#ifdef HAVE_IO_URING
+  std::unique_lock<std::mutex> lock(latch_);
+  if (request != nullptr) {
+    while (in_flight_ == entries_) {
+      slot_cv_.wait(lock);
+    }
+    in_flight_++;
+  }
+
+  // we are the only producer, the kernel only moves the head
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & *sq_mask_;
+  struct io_uring_sqe *sqe = static_cast<struct io_uring_sqe *>(sqes_) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  if (request == nullptr) {
+    sqe->opcode = IORING_OP_NOP;
+  } else {
+    request->iov.iov_base = request->data;
+    request->iov.iov_len = request->size;
+    sqe->opcode = request->write ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = request->fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&request->iov);
+    sqe->len = 1;
+    sqe->off = request->offset;
+  }
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+  while (syscall(__NR_io_uring_enter, ring_fd_, 1, 0, 0, nullptr, 0) < 0) {
+    if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      // the entry stays queued and goes in with the next submission
+      LOG_DEBUG("io_uring_enter failed");
+      break;
+    }
+  }
+#endif
+}
+
+/**
+ * Private helper: finish a request of which result bytes have been moved
+ * already, run its callback and free it
+ */
+void AsyncIO::Complete(Request *request, int result) {
+  if (result >= 0) {
+    result = Transfer(request->fd, request->write, request->data,
+                      request->size, request->offset, result);
+  }
+  request->done(result);
+  delete request;
+}
+
+/**
+ * Wait for completions and run their callbacks, until the stop request
+ * comes back
+ */
+void AsyncIO::ReapThread() {
+#ifdef HAVE_IO_URING
+  while (true) {
+    if (syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS,
+                nullptr, 0) < 0 &&
+        errno != EINTR) {
+      LOG_DEBUG("io_uring_enter failed");
+    }
+    // we are the only consumer, the kernel only moves the tail
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    bool stop = false;
+    for (; head != tail; ++head) {
+      struct io_uring_cqe *cqe =
+          static_cast<struct io_uring_cqe *>(cqes_) + (head & *cq_mask_);
+      Request *request = reinterpret_cast<Request *>(cqe->user_data);
+      int result = cqe->res;
+      __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+      if (request == nullptr) {
+        stop = true;
+        continue;
+      }
+      // free the slot before the callback runs, it may submit again
+      {
+        std::lock_guard<std::mutex> guard(latch_);
+        in_flight_--;
+        slot_cv_.notify_all();
+      }
+      Complete(request, result);
+    }
+    if (stop) {
+      return;
+    }
+  }
+#endif
+}
+
+} // namespace scudb
@@ -1,32 +1,59 @@
 /**
  * disk_manager.cpp
  */
+#include <algorithm>
 #include <assert.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <fcntl.h>
 #include <iostream>
+#include <limits.h>
+#include <memory>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <thread>
+#include <unistd.h>
 
+#include "common/exception.h"
 #include "common/logger.h"
 #include "disk/disk_manager.h"
+#include "page/header_page.h"
 
 namespace scudb {
 
-static char *buffer_used = nullptr;
+// first word of a warm-up file
+static const uint32_t WARMUP_MAGIC = 0x5741524d;
+// every bitmap page ends with this word and the layout version, which has to
+// change whenever the placement of pages in the file or the format of the
+// header page does
+static const uint32_t BITMAP_MAGIC = 0x42544d50;
+static const uint32_t LAYOUT_VERSION = 2;
+static const int BITMAP_TRAILER_SIZE = 8;
 
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
+ * @input direct_io: open the database file with O_DIRECT, page data should
+ * then be page size aligned (unaligned buffers go through a bounce buffer)
+ * @input page_size: page size of a new database, an existing one keeps the
+ * page size recorded in its header page
+ * throws an Exception if an existing file has another layout version
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), flush_log_(false),
-      flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, bool direct_io,
+                         int page_size)
+    : log_fd_(-1), last_log_buffer_(nullptr), db_fd_(-1), file_name_(db_file), direct_io_(false), db_file_size_(0),
+      page_size_(page_size), async_io_(nullptr), free_hint_(0),
+      num_flushes_(0), flush_log_(false), flush_log_f_(nullptr) {
   std::string::size_type n = file_name_.find(".");
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  warmup_name_ = file_name_.substr(0, n) + ".warm";
 
   log_io_.open(log_name_,
                std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
@@ -41,22 +68,63 @@ DiskManager::DiskManager(const std::string &db_file)
     log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app |
                                 std::ios::out);
   }
+  // only for syncing the log, it is written through log_io_
+  log_fd_ = open(log_name_.c_str(), O_RDONLY);
 
-  db_io_.open(db_file,
-              std::ios::binary | std::ios::in | std::ios::out | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+  assert(IsValidPageSize(page_size));
+  // the page size recorded when the database was created wins; read it with
+  // plain I/O, O_DIRECT does not allow such a small read
+  int fd = open(db_file.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    int stored_page_size = 0;
+    if (pread(fd, &stored_page_size, sizeof(stored_page_size),
+              HeaderPage::PAGE_SIZE_OFFSET) == sizeof(stored_page_size) &&
+        IsValidPageSize(stored_page_size)) {
+      page_size_ = stored_page_size;
+    }
+    close(fd);
   }
+
+  int flags = O_RDWR | O_CREAT;
+#ifdef O_DIRECT
+  if (direct_io) {
+    db_fd_ = open(db_file.c_str(), flags | O_DIRECT, 0644);
+    // not every file system supports it
+    if (db_fd_ >= 0) {
+      direct_io_ = true;
+    } else {
+      LOG_DEBUG("O_DIRECT not supported, using buffered I/O");
+    }
+  }
+#endif
+  if (db_fd_ < 0) {
+    db_fd_ = open(db_file.c_str(), flags, 0644);
+  }
+  if (db_fd_ < 0) {
+    LOG_DEBUG("can't open db file");
+    return;
+  }
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) == 0) {
+    db_file_size_ = stat_buf.st_size;
+  }
+  if (!LoadBitmaps()) {
+    close(db_fd_);
+    close(log_fd_);
+    throw Exception("unsupported layout of database file " + db_file);
+  }
+  async_io_ = new AsyncIO(ASYNC_IO_DEPTH);
 }
 
 DiskManager::~DiskManager() {
-  db_io_.close();
+  // waits for outstanding asynchronous I/O
+  delete async_io_;
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+  }
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+  }
   log_io_.close();
 }
 
@@ -64,50 +132,307 @@ DiskManager::~DiskManager() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = page_id * PAGE_SIZE;
-  // set write cursor to offset
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
+  size_t offset = PhysicalOffset(page_id);
   // check for I/O error
-  if (db_io_.bad()) {
+  if (PositionalIO(true, const_cast<char *>(page_data), offset) != page_size_) {
     LOG_DEBUG("I/O error while writing");
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  GrowFileSize(offset + page_size_);
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  int offset = page_id * PAGE_SIZE;
+  size_t offset = PhysicalOffset(page_id);
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (offset > db_file_size_) {
     LOG_DEBUG("I/O error while reading");
     // std::cerr << "I/O error while reading" << std::endl;
   } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
+    int read_count = PositionalIO(false, page_data, offset);
+    if (read_count < 0) {
+      LOG_DEBUG("I/O error while reading");
+      read_count = 0;
+    }
+    // if file ends before reading page_size_
+    if (read_count < page_size_) {
       LOG_DEBUG("Read less than a page");
       // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+      memset(page_data + read_count, 0, page_size_ - read_count);
+    }
+  }
+}
+
+/**
+ * Submit a write of the page, completed by the I/O thread. Failed
+ * asynchronous writes are retried synchronously, which also covers a device
+ * rejecting O_DIRECT. Unaligned data under O_DIRECT is written right away.
+ */
+std::future<void> DiskManager::WritePageAsync(page_id_t page_id,
+                                              const char *page_data) {
+  auto promise = std::make_shared<std::promise<void>>();
+  std::future<void> future = promise->get_future();
+  if (async_io_ == nullptr ||
+      (direct_io_ && reinterpret_cast<uintptr_t>(page_data) % page_size_ != 0)) {
+    WritePage(page_id, page_data);
+    promise->set_value();
+    return future;
+  }
+  size_t offset = PhysicalOffset(page_id);
+  async_io_->Write(db_fd_, page_data, page_size_, offset,
+                   [this, promise, page_id, page_data, offset](int result) {
+                     if (result != page_size_) {
+                       WritePage(page_id, page_data);
+                     } else {
+                       GrowFileSize(offset + page_size_);
+                     }
+                     promise->set_value();
+                   });
+  return future;
+}
+
+/**
+ * Submit a read of the page, completed by the I/O thread. Like ReadPage, the
+ * part beyond the end of file reads as zeros.
+ */
+std::future<void> DiskManager::ReadPageAsync(page_id_t page_id,
+                                             char *page_data) {
+  auto promise = std::make_shared<std::promise<void>>();
+  std::future<void> future = promise->get_future();
+  size_t offset = PhysicalOffset(page_id);
+  if (async_io_ == nullptr || offset >= db_file_size_ ||
+      (direct_io_ && reinterpret_cast<uintptr_t>(page_data) % page_size_ != 0)) {
+    ReadPage(page_id, page_data);
+    promise->set_value();
+    return future;
+  }
+  async_io_->Read(db_fd_, page_data, page_size_, offset,
+                  [this, promise, page_id, page_data](int result) {
+                    if (result < 0) {
+                      ReadPage(page_id, page_data);
+                    } else if (result < page_size_) {
+                      LOG_DEBUG("Read less than a page");
+                      memset(page_data + result, 0, page_size_ - result);
+                    }
+                    promise->set_value();
+                  });
+  return future;
+}
+
+/**
+ * Write the pages, which should be sorted by page id. Pages that are adjacent
+ * in the file (the bitmap pages break runs of page ids) are written by a
+ * single pwritev. A run that could not be written that way, and a page that
+ * is not aligned for O_DIRECT, is written page by page with WritePage.
+ * Nothing is synced, see SyncPages().
+ */
+void DiskManager::WritePages(
+    const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  size_t i = 0;
+  while (i < pages.size()) {
+    size_t offset = PhysicalOffset(pages[i].first);
+    std::vector<struct iovec> iov;
+    while (i + iov.size() < pages.size() && iov.size() < IOV_MAX) {
+      const auto &page = pages[i + iov.size()];
+      if (PhysicalOffset(page.first) != offset + iov.size() * page_size_ ||
+          (direct_io_ &&
+           reinterpret_cast<uintptr_t>(page.second) % page_size_ != 0)) {
+        break;
+      }
+      struct iovec vec;
+      vec.iov_base = const_cast<char *>(page.second);
+      vec.iov_len = page_size_;
+      iov.push_back(vec);
     }
+
+    size_t size = iov.size() * page_size_;
+    ssize_t rc = -1;
+    if (!iov.empty()) {
+      do {
+        rc = pwritev(db_fd_, iov.data(), iov.size(), offset);
+      } while (rc < 0 && errno == EINTR);
+    }
+    if (rc == static_cast<ssize_t>(size)) {
+      GrowFileSize(offset + size);
+      i += iov.size();
+      continue;
+    }
+    // a short write, an error or an unaligned page
+    size_t count = std::max<size_t>(iov.size(), 1);
+    for (size_t j = i; j < i + count; ++j) {
+      WritePage(pages[j].first, pages[j].second);
+    }
+    i += count;
   }
 }
 
+/**
+ * Flush the page writes of the database file to the device. fdatasync skips
+ * the metadata a read does not need, such as the modification time. The
+ * bitmap pages are part of the file, so the allocations so far become durable
+ * with the pages; a bitmap page whose write failed is written again first.
+ */
+void DiskManager::SyncPages() {
+  {
+    std::lock_guard<std::mutex> guard(bitmap_latch_);
+    for (size_t group = 0; group < bitmaps_.size(); ++group) {
+      if (bitmap_dirty_[group]) {
+        WriteBitmap(group);
+      }
+    }
+  }
+  int rc;
+  do {
+    rc = fdatasync(db_fd_);
+  } while (rc < 0 && errno == EINTR);
+  if (rc < 0) {
+    LOG_DEBUG("I/O error while syncing");
+  }
+}
+
+/**
+ * Private helper: read or write the page at offset with pread/pwrite, looping
+ * over short transfers. Returns the number of bytes transferred, which is
+ * less than a page for a read at the end of file, or -1 on error. With
+ * O_DIRECT, unaligned data goes through an aligned bounce buffer, and if the
+ * device rejects the I/O (its block size is larger than the page size) the
+ * file falls back to buffered I/O for good.
+ */
+int DiskManager::PositionalIO(bool write, char *data, size_t offset) {
+  char *buffer = data;
+  bool bounce = direct_io_ &&
+                reinterpret_cast<uintptr_t>(data) % page_size_ != 0;
+  if (bounce) {
+    void *aligned = nullptr;
+    if (posix_memalign(&aligned, page_size_, page_size_) != 0) {
+      return -1;
+    }
+    buffer = static_cast<char *>(aligned);
+    if (write) {
+      memcpy(buffer, data, page_size_);
+    } else {
+      memset(buffer, 0, page_size_);
+    }
+  }
+
+  size_t size = page_size_;
+  size_t done = 0;
+  bool error = false;
+  while (done < size) {
+    ssize_t rc = write ? pwrite(db_fd_, buffer + done, size - done,
+                                offset + done)
+                       : pread(db_fd_, buffer + done, size - done,
+                               offset + done);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+#ifdef O_DIRECT
+    if (rc < 0 && errno == EINVAL && direct_io_) {
+      LOG_DEBUG("O_DIRECT rejected, using buffered I/O");
+      direct_io_ = false;
+      fcntl(db_fd_, F_SETFL, fcntl(db_fd_, F_GETFL) & ~O_DIRECT);
+      continue;
+    }
+#endif
+    if (rc <= 0) {
+      error = rc < 0;
+      break;
+    }
+    done += rc;
+  }
+
+  if (bounce) {
+    if (!write) {
+      memcpy(data, buffer, done);
+    }
+    free(buffer);
+  }
+  return error ? -1 : static_cast<int>(done);
+}
+
+/**
+ * Page sizes are powers of two between 512 bytes, the sector size direct I/O
+ * needs, and 64KB
+ */
+bool DiskManager::IsValidPageSize(int page_size) {
+  return page_size >= 512 && page_size <= 64 * 1024 &&
+         (page_size & (page_size - 1)) == 0;
+}
+
+/**
+ * Private helper: the file is at least end bytes long now
+ */
+void DiskManager::GrowFileSize(size_t end) {
+  size_t size = db_file_size_.load();
+  while (size < end && !db_file_size_.compare_exchange_weak(size, end)) {
+  }
+}
+
+/**
+ * Replace the warm-up file with page_ids. It starts with a header of magic
+ * number, page size and number of ids, followed by the ids. The list goes to
+ * a temporary file that is renamed over the old one, so that a crash leaves
+ * either list behind, never a torn one.
+ */
+void DiskManager::WriteWarmupList(const std::vector<page_id_t> &page_ids) {
+  if (warmup_name_.empty()) {
+    return;
+  }
+  std::string tmp_name = warmup_name_ + ".tmp";
+  std::ofstream out(tmp_name, std::ios::binary | std::ios::trunc);
+  uint32_t header[3] = {WARMUP_MAGIC, static_cast<uint32_t>(page_size_),
+                        static_cast<uint32_t>(page_ids.size())};
+  out.write(reinterpret_cast<const char *>(header), sizeof(header));
+  out.write(reinterpret_cast<const char *>(page_ids.data()),
+            page_ids.size() * sizeof(page_id_t));
+  out.close();
+  if (!out || rename(tmp_name.c_str(), warmup_name_.c_str()) != 0) {
+    LOG_DEBUG("I/O error while writing warm-up file");
+    remove(tmp_name.c_str());
+  }
+}
+
+/**
+ * Read the list of the warm-up file, in the order it was written. A missing
+ * or damaged file, or one of another page size, gives an empty list; ids of
+ * pages deallocated in the meantime are left out.
+ */
+std::vector<page_id_t> DiskManager::ReadWarmupList() {
+  std::vector<page_id_t> page_ids;
+  std::ifstream in(warmup_name_, std::ios::binary);
+  uint32_t header[3];
+  if (!in.read(reinterpret_cast<char *>(header), sizeof(header)) ||
+      header[0] != WARMUP_MAGIC ||
+      header[1] != static_cast<uint32_t>(page_size_) ||
+      GetFileSize(warmup_name_) !=
+          static_cast<int64_t>(sizeof(header) +
+                               header[2] * sizeof(page_id_t))) {
+    return page_ids;
+  }
+  std::vector<page_id_t> saved(header[2]);
+  if (!in.read(reinterpret_cast<char *>(saved.data()),
+               saved.size() * sizeof(page_id_t))) {
+    return page_ids;
+  }
+  std::lock_guard<std::mutex> guard(bitmap_latch_);
+  for (page_id_t page_id : saved) {
+    if (IsAllocated(page_id)) {
+      page_ids.push_back(page_id);
+    }
+  }
+  return page_ids;
+}
+
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
  */
 void DiskManager::WriteLog(char *log_data, int size) {
   // enforce swap log buffer
-  assert(log_data != buffer_used);
-  buffer_used = log_data;
+  assert(log_data != last_log_buffer_);
+  last_log_buffer_ = log_data;
 
   if (size == 0) // no effect on num_flushes_ if log buffer is empty
     return;
@@ -130,6 +455,14 @@ void DiskManager::WriteLog(char *log_data, int size) {
   }
   // needs to flush to keep disk file in sync
   log_io_.flush();
+  // and the records are only durable once synced
+  int rc;
+  do {
+    rc = fdatasync(log_fd_);
+  } while (rc < 0 && errno == EINTR);
+  if (rc < 0) {
+    LOG_DEBUG("I/O error while syncing log");
+  }
   flush_log_ = false;
 }
 
@@ -138,7 +471,7 @@ void DiskManager::WriteLog(char *log_data, int size) {
  * Always read from the beginning and perform sequence read
  * @return: false means already reach the end
  */
-bool DiskManager::ReadLog(char *log_data, int size, int offset) {
+bool DiskManager::ReadLog(char *log_data, int size, int64_t offset) {
   if (offset >= GetFileSize(log_name_)) {
     // LOG_DEBUG("end of log file");
     // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
@@ -156,18 +489,167 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
   return true;
 }
 
+int64_t DiskManager::GetLogSize() {
+  return std::max<int64_t>(GetFileSize(log_name_), 0);
+}
+
 /**
  * Allocate new page (operations like create index/table)
- * For now just keep an increasing counter
+ * Return the lowest page id that is not in use, which reuses deallocated
+ * pages before the file grows. The bitmap page is written right away.
  */
-page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
+page_id_t DiskManager::AllocatePage() {
+  std::lock_guard<std::mutex> guard(bitmap_latch_);
+  int pages_per_bitmap = GetPagesPerBitmap();
+  page_id_t page_id = free_hint_;
+  while (true) {
+    size_t group = page_id / pages_per_bitmap;
+    if (group == bitmaps_.size()) {
+      AddBitmap();
+    }
+    std::vector<char> &bitmap = bitmaps_[group];
+    int bit = page_id % pages_per_bitmap;
+    // skip full bytes
+    if (bit % 8 == 0 && bitmap[bit / 8] == (char)0xFF) {
+      page_id += 8;
+      continue;
+    }
+    if (!(bitmap[bit / 8] & (1 << (bit % 8)))) {
+      bitmap[bit / 8] |= 1 << (bit % 8);
+      WriteBitmap(group);
+      break;
+    }
+    page_id++;
+  }
+  free_hint_ = page_id + 1;
+  return page_id;
+}
 
 /**
  * Deallocate page (operations like drop index/table)
- * Need bitmap in header page for tracking pages
+ * Clear its bit in the bitmap page, so that it can be allocated again
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-  return;
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  assert(page_id != INVALID_PAGE_ID);
+  std::lock_guard<std::mutex> guard(bitmap_latch_);
+  int pages_per_bitmap = GetPagesPerBitmap();
+  size_t group = page_id / pages_per_bitmap;
+  int bit = page_id % pages_per_bitmap;
+  if (!IsAllocated(page_id)) {
+    LOG_DEBUG("deallocate a page that is not allocated");
+    return;
+  }
+  bitmaps_[group][bit / 8] &= ~(1 << (bit % 8));
+  WriteBitmap(group);
+  free_hint_ = std::min(free_hint_, page_id);
+}
+
+/**
+ * Number of data pages one bitmap page keeps track of, a bit for each in all
+ * but the trailer of the page
+ */
+int DiskManager::GetPagesPerBitmap() const {
+  return (page_size_ - BITMAP_TRAILER_SIZE) * 8;
+}
+
+/**
+ * Private helper: every GetPagesPerBitmap() data pages form a group, whose
+ * bitmap page is stored right after the first data page of the group. Page 0
+ * stays at the start of the file, and a small database does not need a sparse
+ * file.
+ */
+size_t DiskManager::PhysicalOffset(page_id_t page_id) {
+  size_t pages_per_bitmap = GetPagesPerBitmap();
+  size_t group = page_id / pages_per_bitmap;
+  size_t physical_page = page_id + group + (page_id % pages_per_bitmap != 0);
+  return physical_page * page_size_;
+}
+
+/**
+ * Private helper: physical offset of the bitmap page of group
+ */
+size_t DiskManager::BitmapOffset(size_t group) {
+  size_t pages_per_bitmap = GetPagesPerBitmap();
+  return (group * (pages_per_bitmap + 1) + 1) * page_size_;
+}
+
+/**
+ * Private helper: append an empty bitmap page with its trailer, with
+ * bitmap_latch_ held
+ */
+void DiskManager::AddBitmap() {
+  bitmaps_.emplace_back(page_size_, 0);
+  bitmap_dirty_.push_back(1);
+  char *trailer = bitmaps_.back().data() + page_size_ - BITMAP_TRAILER_SIZE;
+  memcpy(trailer, &BITMAP_MAGIC, sizeof(BITMAP_MAGIC));
+  memcpy(trailer + sizeof(BITMAP_MAGIC), &LAYOUT_VERSION,
+         sizeof(LAYOUT_VERSION));
+}
+
+/**
+ * Private helper: write the bitmap page of group, with bitmap_latch_ held. It
+ * stays dirty if the write fails, SyncPages() tries again
+ */
+void DiskManager::WriteBitmap(size_t group) {
+  size_t offset = BitmapOffset(group);
+  if (PositionalIO(true, bitmaps_[group].data(), offset) != page_size_) {
+    LOG_DEBUG("I/O error while writing bitmap");
+    bitmap_dirty_[group] = 1;
+    return;
+  }
+  bitmap_dirty_[group] = 0;
+  GrowFileSize(offset + page_size_);
+}
+
+/**
+ * Private helper: read the bitmap pages of an existing database. A group
+ * whose bitmap page is beyond the end of file, or was never written and reads
+ * as zeros, has no page allocated.
+ * return false if a bitmap page lacks the trailer of this layout version,
+ * e.g. in a file written before bitmap pages were interleaved
+ */
+bool DiskManager::LoadBitmaps() {
+  size_t group_size = (GetPagesPerBitmap() + 1) * (size_t)page_size_;
+  size_t num_groups = (db_file_size_ + group_size - 1) / group_size;
+  std::vector<char> zeros(page_size_, 0);
+  for (size_t group = 0; group < num_groups; ++group) {
+    AddBitmap();
+    bitmap_dirty_[group] = 0;
+    size_t offset = BitmapOffset(group);
+    if (offset >= db_file_size_) {
+      continue;
+    }
+    std::vector<char> page(page_size_, 0);
+    if (PositionalIO(false, page.data(), offset) < 0) {
+      LOG_DEBUG("I/O error while reading bitmap");
+      continue;
+    }
+    if (page == zeros) {
+      continue;
+    }
+    if (memcmp(page.data() + page_size_ - BITMAP_TRAILER_SIZE,
+               bitmaps_[group].data() + page_size_ - BITMAP_TRAILER_SIZE,
+               BITMAP_TRAILER_SIZE) != 0) {
+      LOG_DEBUG("bitmap page of another layout version");
+      return false;
+    }
+    bitmaps_[group].swap(page);
+  }
+  return true;
+}
+
+/**
+ * Private helper: whether page_id is allocated, with bitmap_latch_ held
+ */
+bool DiskManager::IsAllocated(page_id_t page_id) {
+  if (page_id < 0) {
+    return false;
+  }
+  int pages_per_bitmap = GetPagesPerBitmap();
+  size_t group = page_id / pages_per_bitmap;
+  int bit = page_id % pages_per_bitmap;
+  return group < bitmaps_.size() &&
+         (bitmaps_[group][bit / 8] & (1 << (bit % 8)));
 }
 
 /**
@@ -183,10 +665,10 @@ bool DiskManager::GetFlushState() const { return flush_log_; }
 /**
  * Private helper function to get disk file size
  */
-int DiskManager::GetFileSize(const std::string &file_name) {
+int64_t DiskManager::GetFileSize(const std::string &file_name) {
   struct stat stat_buf;
   int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? stat_buf.st_size : -1;
+  return rc == 0 ? static_cast<int64_t>(stat_buf.st_size) : -1;
 }
 
 } // namespace scudb
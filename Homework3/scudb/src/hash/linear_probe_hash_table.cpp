@@ -0,0 +1,195 @@
+#include <cassert>
+#include <functional>
+#include <thread>
+
+#include "hash/linear_probe_hash_table.h"
+#include "page/page.h"
+
+namespace scudb {
+
+/*
+ * constructor
+ * capacity: max number of entries, the table never grows
+ */
+    template<typename K, typename V>
+    LinearProbeHashTable<K, V>::LinearProbeHashTable(size_t capacity)
+            : capacity_(capacity), mask_(1), shift_(63)
+    {
+        while (mask_ + 1 < 2 * capacity)
+        {
+            mask_ = mask_ * 2 + 1;
+            shift_--;
+        }
+        slots_ = std::vector<Slot>(mask_ + 1);
+    }
+
+/*
+ * helper function to calculate the home slot of a key. Page ids are dense, so
+ * the hash is spread over the slots by a multiplicative (Fibonacci) hash
+ * instead of taking its low bits.
+ */
+    template<typename K, typename V>
+    size_t LinearProbeHashTable<K, V>::homeSlot(const K &key) const
+    {
+        uint64_t hash = std::hash<K>{}(key);
+        return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    template<typename K, typename V>
+    size_t LinearProbeHashTable<K, V>::findSlot(const K &key) const
+    {
+        size_t slot = homeSlot(key);
+        while (slots_[slot].used.load(std::memory_order_relaxed) &&
+               !(slots_[slot].key.load(std::memory_order_relaxed) == key))
+        {
+            slot = (slot + 1) & mask_;
+        }
+        return slot;
+    }
+
+    template<typename K, typename V>
+    size_t LinearProbeHashTable<K, V>::Size()
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        return size_;
+    }
+
+/*
+ * lookup function to find value associate with input key
+ * Lock free: the probe is repeated until no writer changed the table while it
+ * was running. The number of steps is bounded, so a probe through slots that
+ * are being shifted cannot loop forever. Slots are stored with release and
+ * loaded with acquire: a reader that sees anything a writer stored also sees
+ * the odd sequence number stored before it, and retries.
+ */
+    template<typename K, typename V>
+    bool LinearProbeHashTable<K, V>::Find(const K &key, V &value)
+    {
+        while (true)
+        {
+            uint64_t sequence = sequence_.load(std::memory_order_acquire);
+            if (sequence & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            bool found = false;
+            V foundValue{};
+            size_t slot = homeSlot(key);
+            for (size_t i = 0; i <= mask_; ++i)
+            {
+                const Slot &current = slots_[slot];
+                if (!current.used.load(std::memory_order_acquire))
+                {
+                    break;
+                }
+                if (current.key.load(std::memory_order_acquire) == key)
+                {
+                    foundValue = current.value.load(std::memory_order_acquire);
+                    found = true;
+                    break;
+                }
+                slot = (slot + 1) & mask_;
+            }
+            if (sequence_.load(std::memory_order_relaxed) == sequence)
+            {
+                if (found)
+                {
+                    value = foundValue;
+                }
+                return found;
+            }
+        }
+    }
+
+/*
+ * delete <key,value> entry in hash table
+ * The entries after it in the same cluster that may not stay behind the hole
+ * (their home slot is not between the hole and them) are shifted back into
+ * it one by one, so that no probe sequence is broken.
+ */
+    template<typename K, typename V>
+    bool LinearProbeHashTable<K, V>::Remove(const K &key)
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        size_t hole = findSlot(key);
+        if (!slots_[hole].used.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+
+        beginWrite();
+        size_t slot = hole;
+        while (true)
+        {
+            slot = (slot + 1) & mask_;
+            if (!slots_[slot].used.load(std::memory_order_relaxed))
+            {
+                break;
+            }
+            size_t home = homeSlot(slots_[slot].key.load(std::memory_order_relaxed));
+            // distance from home to the entry, and from the hole to the entry
+            if (((slot - home) & mask_) < ((slot - hole) & mask_))
+            {
+                continue;
+            }
+            slots_[hole].key.store(slots_[slot].key.load(std::memory_order_relaxed),
+                                   std::memory_order_release);
+            slots_[hole].value.store(slots_[slot].value.load(std::memory_order_relaxed),
+                                     std::memory_order_release);
+            hole = slot;
+        }
+        slots_[hole].used.store(false, std::memory_order_release);
+        endWrite();
+        size_--;
+        return true;
+    }
+
+/*
+ * insert <key,value> entry in hash table, replacing the value of an existing
+ * key
+ */
+    template<typename K, typename V>
+    void LinearProbeHashTable<K, V>::Insert(const K &key, const V &value)
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        size_t slot = findSlot(key);
+        bool exists = slots_[slot].used.load(std::memory_order_relaxed);
+        assert(exists || size_ < capacity_);
+
+        beginWrite();
+        slots_[slot].value.store(value, std::memory_order_release);
+        if (!exists)
+        {
+            slots_[slot].key.store(key, std::memory_order_release);
+            slots_[slot].used.store(true, std::memory_order_release);
+            size_++;
+        }
+        endWrite();
+    }
+
+/*
+ * seqlock writer side, latch_ must be held; the slot stores in between are
+ * release stores, which keeps them behind the first increment
+ */
+    template<typename K, typename V>
+    void LinearProbeHashTable<K, V>::beginWrite()
+    {
+        sequence_.store(sequence_.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_relaxed);
+    }
+
+    template<typename K, typename V>
+    void LinearProbeHashTable<K, V>::endWrite()
+    {
+        sequence_.store(sequence_.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_release);
+    }
+
+    template
+    class LinearProbeHashTable<page_id_t, Page *>;
+
+// test purpose
+    template
+    class LinearProbeHashTable<int, int>;
+} // namespace scudb
@@ -0,0 +1,79 @@
+/**
+ * access_trace.h
+ *
+ * Functionality: Records the page accesses of a buffer pool (fetch, new,
+ * unpin, delete) with their time into a compact binary trace file, and reads
+ * such a file back, e.g. to replay it against other replacement policies and
+ * pool sizes, see replacer_simulator.h.
+ *
+ * A trace file starts with a magic number and the pool size it was recorded
+ * with. Each record then is two varints: the microseconds since the previous
+ * record shifted left by two with the operation in the low two bits, and the
+ * page id. A typical record takes about four bytes.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+
+namespace scudb {
+
+    enum class TraceOp { FETCH = 0, NEW = 1, UNPIN = 2, DELETE = 3 };
+
+    struct TraceRecord
+    {
+        uint64_t micros; // since the start of the trace
+        page_id_t pageId;
+        TraceOp op;
+    };
+
+    class AccessTraceRecorder
+    {
+    public:
+        AccessTraceRecorder() {}
+        ~AccessTraceRecorder();
+
+        AccessTraceRecorder(const AccessTraceRecorder &) = delete;
+        AccessTraceRecorder &operator=(const AccessTraceRecorder &) = delete;
+
+        // start a new trace file, replacing a trace in progress; return false
+        // if the file can not be created
+        bool Start(const std::string &file_name, size_t pool_size);
+        // write out the buffered records and close the file
+        void Stop();
+
+        // costs one relaxed load while no trace is being recorded
+        inline void Record(page_id_t page_id, TraceOp op)
+        {
+            if (recording_.load(std::memory_order_relaxed))
+            {
+                append(page_id, op);
+            }
+        }
+
+        // read a whole trace file, return false if it is not one
+        static bool ReadTrace(const std::string &file_name,
+                              std::vector<TraceRecord> &records,
+                              size_t *pool_size = nullptr);
+
+    private:
+        void append(page_id_t page_id, TraceOp op);
+        void putVarint(uint64_t value);
+        void flushBuffer();
+
+        std::atomic<bool> recording_{false};
+        std::mutex latch_; // protects everything below
+        std::ofstream file_;
+        std::vector<char> buffer_; // records not written to file_ yet
+        std::chrono::steady_clock::time_point start_;
+        uint64_t last_micros_ = 0;
+    };
+
+} // namespace scudb
@@ -7,43 +7,215 @@
  */
 
 #pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
 #include <list>
 #include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
 
+#include "buffer/access_trace.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/page_guard.h"
 #include "disk/disk_manager.h"
-#include "hash/extendible_hash.h"
+#include "hash/linear_probe_hash_table.h"
 #include "logging/log_manager.h"
 #include "page/page.h"
 
 namespace scudb {
+    // replacement policy of a buffer pool, chosen at construction
+    enum class ReplacerType { LRU, CLOCK, LRU_K };
+    // how a miss finds a frame: bulk accesses (scans, bulk loads) recycle a
+    // small ring of frames instead of evicting the rest of the pool, a bulk
+    // read skips ring frames that would have to be written back first
+    enum class AccessStrategy { NORMAL, BULK_READ, BULK_WRITE };
+
     class BufferPoolManager {
+        friend class ParallelBufferPoolManager;
+
     public:
         BufferPoolManager(size_t pool_size, DiskManager *disk_manager,
-                          LogManager *log_manager = nullptr);
+                          LogManager *log_manager = nullptr,
+                          ReplacerType replacer_type = ReplacerType::LRU);
+
+        virtual ~BufferPoolManager();
+
+        virtual Page *FetchPage(page_id_t page_id,
+                                AccessStrategy strategy = AccessStrategy::NORMAL);
+
+        // fetch the page and latch it, the guard unlatches and unpins it
+        ReadPageGuard FetchPageRead(page_id_t page_id,
+                                    AccessStrategy strategy = AccessStrategy::NORMAL);
+        WritePageGuard FetchPageWrite(page_id_t page_id,
+                                      AccessStrategy strategy = AccessStrategy::NORMAL);
+
+        virtual bool UnpinPage(page_id_t page_id, bool is_dirty);
+
+        virtual bool FlushPage(page_id_t page_id);
+
+        // write every dirty page and sync the file once, for a checkpoint or
+        // a shutdown
+        virtual void FlushAllPages();
+
+        // make the page writes so far durable, e.g. after a FlushPage()
+        void SyncPages() { disk_manager_->SyncPages(); }
+
+        virtual Page *NewPage(page_id_t &page_id);
 
-        ~BufferPoolManager();
+        virtual bool DeletePage(page_id_t page_id);
 
-        Page *FetchPage(page_id_t page_id);
+        virtual size_t GetPoolSize() { return pool_size_; }
 
-        bool UnpinPage(page_id_t page_id, bool is_dirty);
+        // frames a bulk access of one kind recycles, see AccessStrategy
+        virtual size_t GetRingSize() { return ring_size_; }
 
-        bool FlushPage(page_id_t page_id);
+        // page size of the database, see DiskManager
+        int GetPageSize() { return page_size_; }
 
-        Page *NewPage(page_id_t &page_id);
+        // background writer keeping clean_ratio of the unpinned frames clean
+        virtual void RunFlushThread(double clean_ratio);
+        virtual void StopFlushThread();
 
-        bool DeletePage(page_id_t page_id);
+        // dirty pages written by a miss / by the flush thread so far
+        virtual size_t GetNumForegroundWrites() { return num_foreground_writes_; }
+        virtual size_t GetNumBackgroundWrites() { return num_background_writes_; }
+
+        // hint that the pages will be fetched soon, they are read into
+        // unpinned frames in the background
+        virtual void PrefetchPages(const std::vector<page_id_t> &page_ids,
+                                   AccessStrategy strategy = AccessStrategy::NORMAL);
+
+        // remember the resident pages, hottest first, for WarmUp() after a
+        // restart; meant for a shutdown, after FlushAllPages()
+        virtual void SaveWarmupList();
+
+        // read the pages remembered by SaveWarmupList() into free frames in
+        // the background, with wait return once they are all in; returns
+        // the number of pages requested
+        virtual size_t WarmUp(bool wait = false);
+
+        // counters and latency histograms collected since construction
+        virtual BufferPoolStats GetStats();
+
+        // when all frames are pinned, let FetchPage/NewPage wait up to
+        // timeout for one to be unpinned, first come first served, before
+        // they return nullptr; zero (the default) returns nullptr right away
+        virtual void SetFrameWaitTimeout(std::chrono::milliseconds timeout);
+
+        // the pages with changes that may not be on disk yet, each with the
+        // LSN of its oldest such change (recLSN), for a fuzzy checkpoint; a
+        // page being written may be listed twice
+        virtual void GetDirtyPageTable(std::vector<std::pair<page_id_t, lsn_t>> &dirty_pages);
+
+        // record every fetch, new page, unpin and delete into a trace file
+        // until StopTrace(), see access_trace.h; return false if the file
+        // can not be created
+        bool StartTrace(const std::string &file_name);
+        void StopTrace();
+
+    protected:
+        // used by pools that own no frames themselves and only route requests
+        BufferPoolManager(DiskManager *disk_manager, LogManager *log_manager);
 
     private:
         size_t pool_size_; // number of pages in buffer pool
         Page *pages_;      // array of pages
+        int page_size_;    // size of a page in byte
+        FrameArena *frame_arena_; // page size aligned data of all pages
         DiskManager *disk_manager_;
         LogManager *log_manager_;
         HashTable<page_id_t, Page *> *page_table_; // to keep track of pages
         Replacer<Page *> *replacer_;   // to find an unpinned page for replacement
         std::list<Page *> *free_list_; // to find a free page for replacement
         std::mutex latch_;             // to protect shared data structure
+        // evicted pages whose old contents are still being written to disk
+        std::unordered_set<page_id_t> evicting_;
+        std::condition_variable evict_cv_; // notified when evicting_ shrinks
+        // flush thread related
+        std::thread *flush_thread_ = nullptr;
+        bool flush_running_ = false;
+        double clean_ratio_ = 0;
+        std::condition_variable flush_cv_; // wakes up the flush thread
+        std::atomic<size_t> num_foreground_writes_{0};
+        std::atomic<size_t> num_background_writes_{0};
+        BufferPoolStatsCollector stats_;
+        // the instances of a ParallelBufferPoolManager record into the
+        // recorder of the parallel pool
+        AccessTraceRecorder trace_recorder_;
+        AccessTraceRecorder *trace_;
+        // prefetch thread related, started by the first PrefetchPages()
+        std::thread *prefetch_thread_ = nullptr;
+        bool prefetch_running_ = false;
+        std::deque<std::pair<page_id_t, AccessStrategy>> prefetch_queue_;
+        // frames used by bulk reads / bulk writes, oldest first, with the page
+        // they were given; at most ring_size_ each
+        std::deque<std::pair<Page *, page_id_t>> rings_[2];
+        size_t ring_size_;
+        std::condition_variable prefetch_cv_; // notified when queue grows
+        bool prefetch_busy_ = false;          // requests taken off the queue are loading
+        std::condition_variable prefetch_done_cv_; // notified when they are in
+        // requests waiting for a frame, see SetFrameWaitTimeout()
+        std::chrono::milliseconds frame_wait_timeout_{0};
+        std::deque<uint64_t> frame_waiters_; // their tickets, oldest first
+        uint64_t next_frame_ticket_ = 1;
+        std::atomic<size_t> num_frame_waiters_{0}; // read without the latch
+        std::condition_variable frame_cv_;         // notified when a frame is unpinned
+        struct FrameWait
+        {
+            uint64_t ticket = 0; // 0 while not queued
+            uint64_t startNanos = 0;
+            std::chrono::steady_clock::time_point deadline;
+        };
+
+        // pin count of a frame owned by the pool, see Page
+        static const int FRAME_CLAIMED = -1;
 
-        Page* findUnusedPage();
+        std::unique_lock<std::mutex> lockLatch();
+        Page *pinResident(page_id_t page_id);
+        bool claimFrame(Page *page);
+        bool unpinFrame(Page *page);
+        bool isFrameTurn(const FrameWait &wait);
+        bool waitForFrame(std::unique_lock<std::mutex> &lock, FrameWait &wait);
+        void leaveFrameQueue(FrameWait &wait, bool got_frame);
+        void notifyFrameWaiters();
+        void readPage(page_id_t page_id, char *page_data);
+        void writePage(page_id_t page_id, const char *page_data);
+        // write-ahead logging: the log up to the LSN of a page goes first
+        void forceLog(const char *page_data);
+        // hand the recLSN of a frame over to the write of page_id starting
+        // now, and drop it once the write is done
+        void beginWrite(Page *page, page_id_t page_id);
+        void endWrite(Page *page);
+        Page* findUnusedPage(AccessStrategy strategy);
+        Page *installPage(page_id_t page_id, page_id_t &old_page_id,
+                          bool &write_back,
+                          AccessStrategy strategy = AccessStrategy::NORMAL);
+        void finishInstall(std::unique_lock<std::mutex> &lock, Page *page,
+                           page_id_t old_page_id, bool write_back,
+                           bool read_page);
+        void completeInstall(Page *page, page_id_t old_page_id, bool read_page);
+        // install a page whose id has already been allocated on disk, wait
+        // for a frame only if wait is set
+        Page *newPageWithId(page_id_t page_id, bool wait = true);
+        void flushFrame(std::unique_lock<std::mutex> &lock, Page *page);
+        // FlushAllPages() in three steps, the frames come with their page id
+        void beginFlushAll(std::vector<std::pair<page_id_t, Page *>> &frames);
+        void writeFlushAll(std::vector<std::pair<page_id_t, Page *>> frames);
+        void endFlushAll(const std::vector<std::pair<page_id_t, Page *>> &frames);
+        void flushThread();
+        void stopPrefetchThread();
+        void prefetchThread();
+        void waitForPrefetch();
+        std::vector<page_id_t> residentPages();
+        size_t queueWarmup(const std::vector<page_id_t> &page_ids);
     };
 } // namespace scudb
\ No newline at end of file
@@ -0,0 +1,105 @@
+/**
+ * buffer_pool_stats.h
+ *
+ * Functionality: Counters and latency histograms of a buffer pool. They are
+ * updated on every request, so each thread writes into its own slot (threads
+ * beyond the number of slots share them) with relaxed atomics, and the slots
+ * are only merged when somebody asks for a snapshot.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "common/config.h"
+
+namespace scudb {
+
+    // latencies in nanoseconds, bucket i counts those in [2^i, 2^(i+1)),
+    // bucket 0 also counts 0 and the last one everything above
+    struct LatencyHistogram
+    {
+        static const int NUM_BUCKETS = 32;
+
+        uint64_t buckets[NUM_BUCKETS] = {};
+        uint64_t count = 0;
+        uint64_t total_ns = 0;
+
+        static int BucketOf(uint64_t ns);
+
+        void Merge(const LatencyHistogram &other);
+
+        double MeanNanos() const;
+
+        // upper bound of the bucket holding the given fraction of samples
+        uint64_t PercentileNanos(double fraction) const;
+    };
+
+    // a point in time copy of the statistics of a buffer pool
+    struct BufferPoolStats
+    {
+        uint64_t fetch_hits = 0;
+        uint64_t fetch_misses = 0;
+        uint64_t evictions = 0;           // resident pages replaced by others
+        uint64_t dirty_write_backs = 0;   // by misses, flushes and the flush thread
+        uint64_t new_page_failures = 0;   // NewPage found all frames pinned
+        uint64_t frame_wait_timeouts = 0; // gave up waiting for a frame
+        LatencyHistogram latch_wait;      // acquiring the pool latch
+        LatencyHistogram disk_read;
+        LatencyHistogram disk_write;
+        LatencyHistogram frame_wait;      // all frames pinned, waiting for one
+
+        double HitRatio() const;
+
+        void Merge(const BufferPoolStats &other);
+
+        std::string ToString() const;
+    };
+
+    class BufferPoolStatsCollector
+    {
+    public:
+        enum Counter
+        {
+            FETCH_HITS, FETCH_MISSES, EVICTIONS, DIRTY_WRITE_BACKS,
+            NEW_PAGE_FAILURES, FRAME_WAIT_TIMEOUTS, NUM_COUNTERS
+        };
+        enum Latency { LATCH_WAIT, DISK_READ, DISK_WRITE, FRAME_WAIT, NUM_LATENCIES };
+
+        BufferPoolStatsCollector();
+
+        void Add(Counter counter, uint64_t n = 1)
+        {
+            localSlot().counters[counter].fetch_add(n, std::memory_order_relaxed);
+        }
+
+        void Record(Latency latency, uint64_t ns);
+
+        // merge all the slots, concurrent updates may or may not be included
+        BufferPoolStats Snapshot() const;
+
+        static uint64_t NowNanos()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+    private:
+        struct Slot
+        {
+            std::atomic<uint64_t> counters[NUM_COUNTERS];
+            std::atomic<uint64_t> buckets[NUM_LATENCIES][LatencyHistogram::NUM_BUCKETS];
+            std::atomic<uint64_t> totalNanos[NUM_LATENCIES];
+            // keep the next slot off the last cache line of this one
+            char padding[64];
+        };
+
+        Slot &localSlot();
+
+        Slot slots_[BUFFER_POOL_STATS_SLOTS];
+    };
+
+} // namespace scudb
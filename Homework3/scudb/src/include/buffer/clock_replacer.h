@@ -0,0 +1,58 @@
+/**
+ * clock_replacer.h
+ *
+ * Functionality: CLOCK (second chance) approximation of LRU. Every frame owns
+ * a fixed slot with a reference bit, so no memory is allocated and no tree is
+ * updated on Insert/Erase; Victim sweeps a clock hand over the slots, clearing
+ * reference bits until it finds an unreferenced frame. RecordAccess only sets
+ * the reference bit of the slot, without taking the latch.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "buffer/replacer.h"
+
+namespace scudb {
+
+    template <typename T> class ClockReplacer : public Replacer<T>
+    {
+    public:
+        // frame_index maps every value to its slot in [0, num_frames)
+        ClockReplacer(size_t num_frames, std::function<size_t(const T &)> frame_index);
+
+        ~ClockReplacer();
+
+        void Insert(const T &value);
+
+        bool Victim(T &value);
+
+        bool VictimPreferring(T &value, const std::function<bool(const T &)> &prefer);
+
+        bool Erase(const T &value);
+
+        size_t Size();
+
+        std::vector<T> HotnessOrder();
+
+        void RecordAccess(const T &value);
+
+    private:
+        // latch held: take the next slot from the hand on, referenced or not
+        size_t popNextPresent();
+
+        std::function<size_t(const T &)> frame_index_;
+        std::vector<T> values_;      // value stored in each slot
+        std::vector<char> present_;  // slot is a candidate for eviction
+        // slot was used since the hand last passed
+        std::vector<std::atomic<char>> ref_bits_;
+        size_t hand_ = 0;
+        size_t size_ = 0;
+        std::mutex latch_;
+    };
+
+} // namespace scudb
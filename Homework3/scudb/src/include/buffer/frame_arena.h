@@ -0,0 +1,39 @@
+/**
+ * frame_arena.h
+ *
+ * Functionality: One contiguous, page size aligned block of memory holding
+ * the data of every frame of a buffer pool, apart from the frame metadata
+ * (Page). It is mapped anonymously, on huge pages if the system has some
+ * reserved (MAP_HUGETLB), otherwise with transparent huge pages requested
+ * (MADV_HUGEPAGE), so that a large pool needs few TLB entries. Every frame is
+ * aligned for direct I/O.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace scudb {
+
+    class FrameArena
+    {
+    public:
+        FrameArena(size_t num_frames, int page_size);
+        ~FrameArena();
+
+        FrameArena(const FrameArena &) = delete;
+        FrameArena &operator=(const FrameArena &) = delete;
+
+        char *GetFrame(size_t frame) { return data_ + frame * page_size_; }
+
+        // backed by reserved huge pages rather than regular ones
+        bool IsHugePageBacked() const { return huge_pages_; }
+
+    private:
+        char *mapping_;     // start of the mapping
+        size_t length_;     // length of the mapping
+        char *data_;        // first frame, page size aligned
+        size_t page_size_;
+        bool huge_pages_;
+    };
+} // namespace scudb
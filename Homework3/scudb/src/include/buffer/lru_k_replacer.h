@@ -0,0 +1,66 @@
+/**
+ * lru_k_replacer.h
+ *
+ * Functionality: LRU-K replacement. Every frame remembers the timestamps of
+ * its last K accesses (reported through RecordAccess). The victim is the frame
+ * whose K-th most recent access lies furthest in the past; frames accessed
+ * fewer than K times count as infinitely far and are evicted first, oldest
+ * first access first. Pages touched once by a sequential scan are therefore
+ * evicted before pages that are used over and over, like B+ tree inner pages.
+ * RecordAccess writes the history of the slot with atomics and takes no latch,
+ * so concurrent hits do not serialize on the replacer.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "buffer/replacer.h"
+
+namespace scudb {
+
+    template <typename T> class LRUKReplacer : public Replacer<T>
+    {
+    public:
+        // frame_index maps every value to its slot in [0, num_frames)
+        LRUKReplacer(size_t num_frames, std::function<size_t(const T &)> frame_index,
+                     size_t k = 2);
+
+        ~LRUKReplacer();
+
+        void Insert(const T &value);
+
+        bool Victim(T &value);
+
+        bool VictimPreferring(T &value, const std::function<bool(const T &)> &prefer);
+
+        bool Erase(const T &value);
+
+        bool Remove(const T &value);
+
+        size_t Size();
+
+        std::vector<T> HotnessOrder();
+
+        void RecordAccess(const T &value);
+
+    private:
+        bool victim(T &value, const std::function<bool(const T &)> *prefer);
+        size_t distanceTimestamp(size_t idx);
+
+        std::function<size_t(const T &)> frame_index_;
+        size_t k_;
+        std::vector<T> values_;     // value stored in each slot
+        std::vector<char> present_; // slot is a candidate for eviction
+        // last k access timestamps of each slot, as a ring of k entries
+        std::vector<std::atomic<size_t>> history_;
+        std::vector<std::atomic<size_t>> num_accesses_;
+        std::atomic<size_t> current_timestamp_{0};
+        size_t size_ = 0;
+        std::mutex latch_;
+    };
+
+} // namespace scudb
@@ -12,6 +12,7 @@
 #include <map>
 #include <mutex>
 #include <memory>
+#include <vector>
 
 #include "buffer/replacer.h"
 #include "hash/extendible_hash.h"
@@ -32,10 +33,14 @@ namespace scudb {
 
         bool Victim(T &value);
 
+        bool VictimPreferring(T &value, const std::function<bool(const T &)> &prefer);
+
         bool Erase(const T &value);
 
         size_t Size();
 
+        std::vector<T> HotnessOrder();
+
     private:
         // add your member variables here
         struct DLinkedNode
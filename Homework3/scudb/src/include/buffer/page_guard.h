@@ -0,0 +1,119 @@
+/**
+ * page_guard.h
+ *
+ * Functionality: RAII handles on a page pinned in the buffer pool. A guard
+ * unpins its page when it goes out of scope, the read/write guards also hold
+ * the page latch in shared/exclusive mode and release it first. Guards can be
+ * moved but not copied; an empty guard (whose fetch failed) converts to false.
+ */
+
+#pragma once
+
+#include "page/page.h"
+
+namespace scudb {
+
+    class BufferPoolManager;
+
+    // pin only, for pages that are protected by some other latch
+    class BasicPageGuard
+    {
+    public:
+        BasicPageGuard() = default;
+
+        // takes over a pin of page, which may be nullptr
+        BasicPageGuard(BufferPoolManager *bufferPoolManager, Page *page);
+
+        BasicPageGuard(BasicPageGuard &&other);
+
+        BasicPageGuard &operator=(BasicPageGuard &&other);
+
+        BasicPageGuard(const BasicPageGuard &) = delete;
+
+        BasicPageGuard &operator=(const BasicPageGuard &) = delete;
+
+        ~BasicPageGuard() { Drop(); }
+
+        // unpin the page now, the guard is empty afterwards
+        void Drop();
+
+        // the page is written back before it is evicted
+        void MarkDirty() { is_dirty_ = true; }
+
+        explicit operator bool() const { return page_ != nullptr; }
+
+        Page *GetPage() const { return page_; }
+
+        page_id_t GetPageId() const { return page_->GetPageId(); }
+
+        char *GetData() const { return page_->GetData(); }
+
+    private:
+        BufferPoolManager *buffer_pool_manager_ = nullptr;
+        Page *page_ = nullptr;
+        bool is_dirty_ = false;
+    };
+
+    // pin and shared latch
+    class ReadPageGuard
+    {
+    public:
+        ReadPageGuard() = default;
+
+        // takes over a pin of page and latches it
+        ReadPageGuard(BufferPoolManager *bufferPoolManager, Page *page);
+
+        ReadPageGuard(ReadPageGuard &&other) = default;
+
+        ReadPageGuard &operator=(ReadPageGuard &&other);
+
+        ~ReadPageGuard() { Drop(); }
+
+        // unlatch and unpin the page now, the guard is empty afterwards
+        void Drop();
+
+        explicit operator bool() const { return static_cast<bool>(guard_); }
+
+        Page *GetPage() const { return guard_.GetPage(); }
+
+        page_id_t GetPageId() const { return guard_.GetPageId(); }
+
+        const char *GetData() const { return guard_.GetData(); }
+
+    private:
+        BasicPageGuard guard_;
+    };
+
+    // pin and exclusive latch
+    class WritePageGuard
+    {
+    public:
+        WritePageGuard() = default;
+
+        // takes over a pin of page and latches it
+        WritePageGuard(BufferPoolManager *bufferPoolManager, Page *page);
+
+        WritePageGuard(WritePageGuard &&other) = default;
+
+        WritePageGuard &operator=(WritePageGuard &&other);
+
+        ~WritePageGuard() { Drop(); }
+
+        // unlatch and unpin the page now, the guard is empty afterwards
+        void Drop();
+
+        void MarkDirty() { guard_.MarkDirty(); }
+
+        explicit operator bool() const { return static_cast<bool>(guard_); }
+
+        Page *GetPage() const { return guard_.GetPage(); }
+
+        page_id_t GetPageId() const { return guard_.GetPageId(); }
+
+        char *GetData() const { return guard_.GetData(); }
+
+    private:
+        BasicPageGuard guard_;
+    };
+
+} // namespace scudb
@@ -0,0 +1,71 @@
+/*
+ * parallel_buffer_pool_manager.h
+ *
+ * Functionality: A buffer pool made up of several independent
+ * BufferPoolManager instances. Every page id is hashed onto exactly one
+ * instance, so requests for pages living in different instances never contend
+ * on the same latch, page table, replacer or free list.
+ */
+
+#pragma once
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+
+namespace scudb {
+    class ParallelBufferPoolManager : public BufferPoolManager {
+    public:
+        // pool_size frames are split evenly among num_instances instances
+        ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                  DiskManager *disk_manager,
+                                  LogManager *log_manager = nullptr,
+                                  ReplacerType replacer_type = ReplacerType::LRU);
+
+        ~ParallelBufferPoolManager();
+
+        Page *FetchPage(page_id_t page_id,
+                        AccessStrategy strategy = AccessStrategy::NORMAL) override;
+
+        bool UnpinPage(page_id_t page_id, bool is_dirty) override;
+
+        bool FlushPage(page_id_t page_id) override;
+
+        void FlushAllPages() override;
+
+        Page *NewPage(page_id_t &page_id) override;
+
+        bool DeletePage(page_id_t page_id) override;
+
+        size_t GetPoolSize() override { return total_pool_size_; }
+
+        // consecutive pages go to different instances, so a bulk access
+        // recycles the rings of all of them, each as small as the smallest
+        size_t GetRingSize() override;
+
+        size_t GetNumInstances() { return instances_.size(); }
+
+        void RunFlushThread(double clean_ratio) override;
+        void StopFlushThread() override;
+
+        size_t GetNumForegroundWrites() override;
+        size_t GetNumBackgroundWrites() override;
+
+        void PrefetchPages(const std::vector<page_id_t> &page_ids,
+                           AccessStrategy strategy = AccessStrategy::NORMAL) override;
+
+        void SaveWarmupList() override;
+        size_t WarmUp(bool wait = false) override;
+
+        BufferPoolStats GetStats() override;
+
+        void SetFrameWaitTimeout(std::chrono::milliseconds timeout) override;
+
+        void GetDirtyPageTable(std::vector<std::pair<page_id_t, lsn_t>> &dirty_pages) override;
+
+    private:
+        BufferPoolManager *getInstance(page_id_t page_id);
+
+        size_t total_pool_size_; // number of frames over all instances
+        std::vector<BufferPoolManager *> instances_;
+    };
+} // namespace scudb
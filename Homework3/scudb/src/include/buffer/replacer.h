@@ -6,6 +6,8 @@
 #pragma once
 
 #include <cstdlib>
+#include <functional>
+#include <vector>
 
 namespace scudb {
 
@@ -17,6 +19,22 @@ public:
   virtual bool Victim(T &value) = 0;
   virtual bool Erase(const T &value) = 0;
   virtual size_t Size() = 0;
+  // like Erase, but value is about to stand for something else, so the
+  // policy also forgets whatever history it keeps for it
+  virtual bool Remove(const T &value) { return Erase(value); }
+  // called on every access of value, for policies that track access history;
+  // the hit path of the buffer pool calls it without any latch, so it must
+  // not block either
+  virtual void RecordAccess(const T &value) {}
+  // like Victim, but among the candidates the policy considers about as good
+  // as the regular victim, pick one that satisfies prefer if there is any
+  virtual bool VictimPreferring(T &value,
+                                const std::function<bool(const T &)> &prefer) {
+    return Victim(value);
+  }
+  // the candidates ordered by how long the policy would keep them, the last
+  // one to be evicted first
+  virtual std::vector<T> HotnessOrder() = 0;
 };
 
 } // namespace scudb
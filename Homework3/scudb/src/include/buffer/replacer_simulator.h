@@ -0,0 +1,49 @@
+/**
+ * replacer_simulator.h
+ *
+ * Functionality: Replays an access trace recorded by a buffer pool (see
+ * access_trace.h) against a replacement policy at a given pool size, without
+ * any disk I/O, to compare policies and pool sizes on a real workload. Pins
+ * are replayed as well, a pinned frame is never a victim. The trace does not
+ * tell which pages are dirty, so the preference of the pool for clean
+ * victims is not replayed. The records of a multi-threaded trace are
+ * replayed in time order, which is only close to the order the pool saw
+ * them in.
+ */
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "buffer/access_trace.h"
+#include "buffer/replacer.h"
+
+namespace scudb {
+
+    struct SimulationResult
+    {
+        size_t poolSize = 0;
+        size_t fetches = 0;
+        size_t misses = 0;
+        // fetches and new pages that found every frame pinned
+        size_t failures = 0;
+
+        double MissRatio() const
+        {
+            return fetches == 0 ? 0 : static_cast<double>(misses) / fetches;
+        }
+    };
+
+    // replay trace with pool_size frames, numbered from 0, whose victims are
+    // chosen by replacer; replacer must be empty
+    SimulationResult SimulateTrace(const std::vector<TraceRecord> &trace,
+                                   size_t pool_size, Replacer<int> &replacer);
+
+    // one simulation per pool size, with a replacer made by make_replacer
+    std::vector<SimulationResult> MissRatioCurve(
+            const std::vector<TraceRecord> &trace,
+            const std::vector<size_t> &pool_sizes,
+            const std::function<Replacer<int> *(size_t pool_size)> &make_replacer);
+
+} // namespace scudb
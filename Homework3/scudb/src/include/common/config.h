@@ -14,6 +14,10 @@ namespace scudb {
 
 extern std::chrono::duration<long long int> LOG_TIMEOUT;
 
+extern std::chrono::milliseconds BUFFER_POOL_FLUSH_TIMEOUT;
+
+extern std::chrono::milliseconds CHECKPOINT_TIMEOUT;
+
 extern std::atomic<bool> ENABLE_LOGGING;
 
 #define INVALID_PAGE_ID -1 // representing an invalid page id
@@ -25,6 +29,14 @@ extern std::atomic<bool> ENABLE_LOGGING;
   ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE) // size of a log buffer in byte
 #define BUCKET_SIZE 50                 // size of extendible hash bucket
 #define BUFFER_POOL_SIZE 10            // size of buffer pool
+#define LRUK_REPLACER_K 2              // K of the LRU-K buffer pool replacer
+#define TABLE_SCAN_PREFETCH_WINDOW 4   // pages a table scan reads ahead
+#define ASYNC_IO_DEPTH 32              // max asynchronous page I/Os in flight
+#define BUFFER_POOL_STATS_SLOTS 16     // per thread statistics slots of a pool
+#define BUFFER_POOL_RING_SIZE 16       // max frames recycled by bulk accesses
+#define BUFFER_POOL_WARMUP_BATCH 256   // warm-up pages read in page id order
+#define LOG_RECOVERY_READ_SIZE (1 << 20) // bytes of log read at once by redo
+#define LOG_RECOVERY_THREADS 4         // redo worker threads
 
 typedef int32_t page_id_t; // page id type
 typedef int32_t txn_id_t;  // transaction id type
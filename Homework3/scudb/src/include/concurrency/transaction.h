@@ -109,8 +109,8 @@ private:
   txn_id_t txn_id_;
   // Below are used by transaction, undo set
   std::shared_ptr<std::deque<WriteRecord>> write_set_;
-  // prev lsn
-  lsn_t prev_lsn_;
+  // prev lsn, read by checkpoints while the transaction runs
+  std::atomic<lsn_t> prev_lsn_;
 
   // Below are used by concurrent index
   // this deque contains page pointer that was latche during index operation
@@ -5,7 +5,11 @@
 
 #pragma once
 #include <atomic>
+#include <mutex>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
@@ -22,10 +26,21 @@ public:
   void Commit(Transaction *txn);
   void Abort(Transaction *txn);
 
+  // the running transactions with their last LSN, and the LSN of the
+  // oldest BEGIN among them (INVALID_LSN if there is none); only the
+  // transactions begun with logging on are known
+  void GetActiveTransactions(std::vector<std::pair<txn_id_t, lsn_t>> &active_txns,
+                             lsn_t &oldest_begin_lsn);
+
 private:
+  void EndTransaction(Transaction *txn);
+
   std::atomic<txn_id_t> next_txn_id_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
+  // running transactions and the LSN of their BEGIN record
+  std::mutex latch_;
+  std::unordered_map<txn_id_t, std::pair<Transaction *, lsn_t>> active_txns_;
 };
 
 } // namespace scudb
@@ -0,0 +1,68 @@
+/**
+ * async_io.h
+ *
+ * Asynchronous positional file I/O on top of io_uring, driven through the raw
+ * system calls so that no extra library is needed. Requests are submitted
+ * from any thread, a reaper thread collects the completions and runs the
+ * callbacks. If io_uring is not available, either on the build host or in
+ * the running kernel, requests are executed synchronously by the submitter.
+ */
+
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <sys/types.h>
+#include <thread>
+
+namespace scudb {
+
+class AsyncIO {
+public:
+  // called with the number of bytes transferred, or -errno on error
+  typedef std::function<void(int result)> Callback;
+
+  // entries: maximum number of requests in flight
+  explicit AsyncIO(unsigned entries);
+  ~AsyncIO();
+
+  void Read(int fd, char *data, size_t size, off_t offset, Callback done);
+  void Write(int fd, const char *data, size_t size, off_t offset,
+             Callback done);
+
+  // false if requests are executed synchronously
+  inline bool IsAsync() const { return ring_fd_ >= 0; }
+
+private:
+  struct Request;
+
+  void Setup(unsigned entries);
+  void Submit(Request *request);
+  void Complete(Request *request, int result);
+  void ReapThread();
+
+  int ring_fd_ = -1;
+  unsigned entries_ = 0;
+  // shared memory of the ring, see io_uring_setup(2)
+  void *sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void *cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  void *sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+  unsigned *sq_tail_ = nullptr;
+  unsigned *sq_mask_ = nullptr;
+  unsigned *sq_array_ = nullptr;
+  unsigned *cq_head_ = nullptr;
+  unsigned *cq_tail_ = nullptr;
+  unsigned *cq_mask_ = nullptr;
+  void *cqes_ = nullptr;
+
+  std::mutex latch_; // protects the submission queue and in_flight_
+  std::condition_variable slot_cv_; // notified when in_flight_ shrinks
+  unsigned in_flight_ = 0;
+  std::thread *reap_thread_ = nullptr;
+};
+
+} // namespace scudb
@@ -11,40 +11,89 @@
 #include <atomic>
 #include <fstream>
 #include <future>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "disk/async_io.h"
 
 namespace scudb {
 
 class DiskManager {
 public:
-  DiskManager(const std::string &db_file);
+  // direct_io bypasses the OS page cache for the database file (O_DIRECT)
+  DiskManager(const std::string &db_file, bool direct_io = false,
+              int page_size = PAGE_SIZE);
   ~DiskManager();
 
   void WritePage(page_id_t page_id, const char *page_data);
   void ReadPage(page_id_t page_id, char *page_data);
+  // same as above, but only submit the I/O; the future becomes ready once it
+  // completed, page_data must stay valid until then
+  std::future<void> WritePageAsync(page_id_t page_id, const char *page_data);
+  std::future<void> ReadPageAsync(page_id_t page_id, char *page_data);
+  // write a batch of pages sorted by page id, adjacent ones in one system call
+  void WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages);
+  // make the page writes so far durable (fdatasync)
+  void SyncPages();
+
+  // page ids a buffer pool should read in after a restart, kept in a side
+  // file next to the db file; reading drops pages that are not allocated
+  void WriteWarmupList(const std::vector<page_id_t> &page_ids);
+  std::vector<page_id_t> ReadWarmupList();
 
   void WriteLog(char *log_data, int size);
-  bool ReadLog(char *log_data, int size, int offset);
+  bool ReadLog(char *log_data, int size, int64_t offset);
+  // bytes in the log file so far
+  int64_t GetLogSize();
 
   page_id_t AllocatePage();
   void DeallocatePage(page_id_t page_id);
 
+  inline int GetPageSize() const { return page_size_; }
+  int GetPagesPerBitmap() const;
+  static bool IsValidPageSize(int page_size);
+
   int GetNumFlushes() const;
   bool GetFlushState() const;
   inline void SetFlushLogFuture(std::future<void> *f) { flush_log_f_ = f; }
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
 private:
-  int GetFileSize(const std::string &name);
+  int64_t GetFileSize(const std::string &name);
+  int PositionalIO(bool write, char *data, size_t offset);
+  void GrowFileSize(size_t end);
+  size_t PhysicalOffset(page_id_t page_id);
+  size_t BitmapOffset(size_t group);
+  void AddBitmap();
+  void WriteBitmap(size_t group);
+  bool LoadBitmaps();
+  bool IsAllocated(page_id_t page_id);
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  int log_fd_; // descriptor of the log file for fdatasync
+  // buffer of the last WriteLog(), the log manager has to alternate buffers
+  char *last_log_buffer_;
+  // warm-up file, see WriteWarmupList()
+  std::string warmup_name_;
+  // descriptor of db file, pages are read and written with pread/pwrite so
+  // that concurrent page I/O does not share a cursor
+  int db_fd_;
   std::string file_name_;
-  std::atomic<page_id_t> next_page_id_;
+  std::atomic<bool> direct_io_;
+  // size of db file, kept up to date by WritePage instead of stat()
+  std::atomic<size_t> db_file_size_;
+  int page_size_; // size of a page of this database in byte
+  AsyncIO *async_io_;
+  // free space bitmaps, one page per GetPagesPerBitmap() data pages, bit set
+  // means the page is allocated; kept in memory and written through on change
+  std::mutex bitmap_latch_;
+  std::vector<std::vector<char>> bitmaps_;
+  std::vector<char> bitmap_dirty_; // the last write of the bitmap failed
+  page_id_t free_hint_; // no page below it is free
   int num_flushes_;
   bool flush_log_;
   std::future<void> *flush_log_f_;
@@ -0,0 +1,65 @@
+/**
+ * linear_probe_hash_table.h
+ *
+ * Functionality: Fixed capacity hash table with open addressing (linear
+ * probing), meant as the page table of a buffer pool, which never holds more
+ * pages than it has frames. Writers are serialized by a latch and bump a
+ * sequence number around every change; Find takes no lock at all, it probes
+ * optimistically and starts over if the sequence number moved meanwhile
+ * (a seqlock). Removal shifts the following entries back instead of leaving
+ * tombstones, so probe sequences stay short however many pages came and went.
+ * Keys and values must be trivially copyable, they are kept in atomics so
+ * that a reader racing with a writer is well defined.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "hash/hash_table.h"
+
+namespace scudb {
+
+    template<typename K, typename V>
+    class LinearProbeHashTable : public HashTable<K, V>
+    {
+        struct Slot
+        {
+            std::atomic<bool> used{false};
+            std::atomic<K> key;
+            std::atomic<V> value;
+        };
+
+    public:
+        // room for at least capacity entries, at most half of the slots are used
+        explicit LinearProbeHashTable(size_t capacity);
+
+        size_t GetCapacity() const { return capacity_; }
+        size_t Size();
+
+        // lookup and modifier
+        bool Find(const K &key, V &value) override;
+        bool Remove(const K &key) override;
+        // asserts that there is room for another key
+        void Insert(const K &key, const V &value) override;
+
+    private:
+        size_t homeSlot(const K &key) const;
+        // slot holding key, or the empty slot ending its probe sequence;
+        // writers only
+        size_t findSlot(const K &key) const;
+        void beginWrite();
+        void endWrite();
+
+        size_t capacity_;
+        size_t mask_;     // number of slots - 1, a power of two
+        int shift_;       // 64 - log2(number of slots)
+        std::vector<Slot> slots_;
+        size_t size_ = 0;
+        std::mutex latch_; // serializes writers
+        std::atomic<uint64_t> sequence_{0}; // odd while a writer is changing slots
+    };
+} // namespace scudb
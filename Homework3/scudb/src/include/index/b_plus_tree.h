@@ -60,13 +60,12 @@ public:
   void RemoveFromFile(const std::string &file_name,
                       Transaction *transaction = nullptr);
   // expose for test purpose
+  ReadPageGuard FindLeafPageRead(const KeyType &key, bool leftMost = false);
   B_PLUS_TREE_LEAF_PAGE_TYPE *FindLeafPage(const KeyType &key,
                                            bool leftMost = false,
                                            OpType op = OpType::READ,
                                            Transaction *transaction = nullptr);
 private:
-  BPlusTreePage *FetchPage(page_id_t page_id);
-
   void StartNewTree(const KeyType &key, const ValueType &value);
 
   bool InsertIntoLeaf(const KeyType &key, const ValueType &value,
@@ -98,7 +97,11 @@ private:
 
   BPlusTreePage *CrabingProtocalFetchPage(page_id_t page_id,OpType op, page_id_t previous, Transaction *transaction);
 
-  void FreePagesInTransaction(bool exclusive,  Transaction *transaction, page_id_t cur = -1);
+  void FreePagesInTransaction(bool exclusive,  Transaction *transaction);
+
+  bool ReserveNewPages(size_t count);
+  Page *TakeReservedPage(page_id_t &page_id);
+  void ReleaseReservedPages();
 
   inline void Lock(bool exclusive,Page * page) {
     if (exclusive) {
@@ -115,11 +118,6 @@ private:
       page->RUnlatch();
     }
   }
-  inline void Unlock(bool exclusive,page_id_t pageId) {
-    auto page = buffer_pool_manager_->FetchPage(pageId);
-    Unlock(exclusive,page);
-    buffer_pool_manager_->UnpinPage(pageId,exclusive);
-  }
   inline void LockRootPageId(bool exclusive) {
     if (exclusive) {
       mutex_.WLock();
@@ -149,6 +147,8 @@ private:
   KeyComparator comparator_;
   RWMutex mutex_;
   static thread_local int rootLockedCnt;
+  // new pages reserved for the splits of the running insertion
+  static thread_local std::vector<std::pair<page_id_t, Page *>> reservedPages;
 };
 
 } // namespace scudb
@@ -3,6 +3,7 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include "common/exception.h"
 #include "page/b_plus_tree_leaf_page.h"
 
 namespace scudb {
@@ -14,7 +15,9 @@ namespace scudb {
     class IndexIterator {
     public:
         // you may define your own constructor based on your member variables
-        IndexIterator(B_PLUS_TREE_LEAF_PAGE_TYPE *leaf, int index, BufferPoolManager *bufferPoolManager);
+        // guard: the leaf page, latched in shared mode, or empty at the end
+        IndexIterator(ReadPageGuard &&guard, int index, BufferPoolManager *bufferPoolManager);
+        IndexIterator(IndexIterator &&other) = default;
         ~IndexIterator();
 
         bool isEnd();
@@ -30,16 +33,18 @@ namespace scudb {
             if (index_ >= leaf_->GetSize())
             {
                 page_id_t next = leaf_->GetNextPageId();
-                UnlockAndUnPin();
-                if (next == INVALID_PAGE_ID)
+                // give up the leaf before latching its sibling, deletion
+                // latches siblings from right to left
+                guard_.Drop();
+                leaf_ = nullptr;
+                if (next != INVALID_PAGE_ID)
                 {
-                    leaf_ = nullptr;
-                }
-                else
-                {
-                    Page *page = bufferPoolManager_->FetchPage(next);
-                    page->RLatch();
-                    leaf_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
+                    guard_ = bufferPoolManager_->FetchPageRead(next);
+                    if (!guard_)
+                    {
+                        throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while iterating");
+                    }
+                    leaf_ = reinterpret_cast<const B_PLUS_TREE_LEAF_PAGE_TYPE *>(guard_.GetData());
                     index_ = 0;
                 }
             }
@@ -48,14 +53,9 @@ namespace scudb {
 
     private:
         // add your own private member variables here
-        void UnlockAndUnPin()
-        {
-            bufferPoolManager_->FetchPage(leaf_->GetPageId())->RUnlatch();
-            bufferPoolManager_->UnpinPage(leaf_->GetPageId(), false);
-            bufferPoolManager_->UnpinPage(leaf_->GetPageId(), false);
-        }
         int index_;
-        B_PLUS_TREE_LEAF_PAGE_TYPE *leaf_;
+        ReadPageGuard guard_;
+        const B_PLUS_TREE_LEAF_PAGE_TYPE *leaf_;
         BufferPoolManager *bufferPoolManager_;
     };
 
@@ -0,0 +1,70 @@
+/**
+ * checkpoint_manager.h
+ * Fuzzy checkpoints bound the log recovery has to read. Transactions and
+ * the buffer pool go on while a checkpoint is taken, and no page is written
+ * for it: a BEGIN_CHECKPOINT record is appended, then an END_CHECKPOINT
+ * record with the active transaction table and the dirty page table. Once
+ * that is on disk, the master record in the header page tells recovery
+ * where to find it, and where to start reading: at the oldest recLSN of a
+ * dirty page or the oldest BEGIN of an active transaction, whichever is
+ * older.
+ */
+
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "logging/log_manager.h"
+
+namespace scudb {
+
+// the last checkpoint, kept in the header page
+struct MasterRecord {
+  lsn_t checkpoint_lsn = INVALID_LSN; // of its END_CHECKPOINT record
+  int64_t checkpoint_offset = 0; // log file offset to look for that record from
+  int64_t redo_offset = 0;       // log file offset recovery reads from
+};
+
+class CheckpointManager {
+public:
+  CheckpointManager(TransactionManager *transaction_manager,
+                    LogManager *log_manager,
+                    BufferPoolManager *buffer_pool_manager)
+      : transaction_manager_(transaction_manager), log_manager_(log_manager),
+        buffer_pool_manager_(buffer_pool_manager),
+        checkpoint_thread_(nullptr), running_(false) {}
+
+  ~CheckpointManager() { StopCheckpointThread(); }
+
+  // take a checkpoint every CHECKPOINT_TIMEOUT
+  void RunCheckpointThread();
+  void StopCheckpointThread();
+
+  // take a checkpoint now; false if the tables do not fit into a log record
+  // or there is no header page to keep the master record in
+  bool Checkpoint();
+
+  // the master record of the last checkpoint, false if there is none
+  static bool ReadMasterRecord(BufferPoolManager *buffer_pool_manager,
+                               MasterRecord &master);
+
+private:
+  void CheckpointThread();
+  bool WriteMasterRecord(const MasterRecord &master);
+
+  TransactionManager *transaction_manager_;
+  LogManager *log_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  // one checkpoint at a time
+  std::mutex checkpoint_latch_;
+  // checkpoint thread
+  std::mutex latch_;
+  std::condition_variable cv_;
+  std::thread *checkpoint_thread_;
+  bool running_;
+};
+
+} // namespace scudb
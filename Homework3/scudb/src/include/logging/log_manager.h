@@ -3,6 +3,14 @@
  * log manager maintain a separate thread that is awaken when the log buffer is
  * full or time out(every X second) to write log buffer's content into disk log
  * file.
+ * Group commit: records are appended to one buffer while the flush thread
+ * writes the previous group from the other. A flush takes everything
+ * appended up to its start, so all transactions that committed while the
+ * last write was in progress share one write (and one sync).
+ * Appending takes no latch: a single fetch-add on tail_ reserves the LSN and
+ * the bytes of a record, which is then serialized in parallel with others.
+ * Where each flush started in the log file is kept, so that a checkpoint can
+ * tell recovery where to start reading.
  */
 
 #pragma once
@@ -10,6 +18,9 @@
 #include <condition_variable>
 #include <future>
 #include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "disk/disk_manager.h"
 #include "logging/log_record.h"
@@ -19,18 +30,25 @@ namespace scudb {
 class LogManager {
 public:
   LogManager(DiskManager *disk_manager)
-      : next_lsn_(0), persistent_lsn_(INVALID_LSN),
+      : tail_(0), seal_(NO_SEAL), persistent_lsn_(INVALID_LSN),
+        flush_thread_(nullptr), running_(false), flush_requested_(false),
+        flushing_(false),
         disk_manager_(disk_manager) {
-    // TODO: you may intialize your own defined memeber variables here
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
-    flush_buffer_ = new char[LOG_BUFFER_SIZE];
+    log_size_ = disk_manager->GetLogSize();
+    for (int i = 0; i < 2; ++i) {
+      buffers_[i] = new char[LOG_BUFFER_SIZE];
+      filled_[i] = 0;
+    }
   }
 
   ~LogManager() {
-    delete[] log_buffer_;
-    delete[] flush_buffer_;
-    log_buffer_ = nullptr;
-    flush_buffer_ = nullptr;
+    if (flush_thread_ != nullptr) {
+      StopFlushThread();
+    }
+    for (int i = 0; i < 2; ++i) {
+      delete[] buffers_[i];
+      buffers_[i] = nullptr;
+    }
   }
   // spawn a separate thread to wake up periodically to flush
   void RunFlushThread();
@@ -39,30 +57,81 @@ public:
   // append a log record into log buffer
   lsn_t AppendLogRecord(LogRecord &log_record);
 
+  // block until the records up to and including lsn are on disk, e.g. the
+  // commit record of a transaction or the last change of a page to be
+  // written; the flush thread writes them together with everything else
+  // appended so far
+  void WaitForFlush(lsn_t lsn);
+
+  // offset in the log file to read from to find the record of lsn, which
+  // must be on disk; 0 for records appended before this log manager
+  int64_t GetLogOffset(lsn_t lsn) const;
+  // no offset of a record older than lsn is asked for any more, e.g. once a
+  // master record tells recovery to start at lsn
+  void ForgetLogOffsets(lsn_t lsn);
+
   // get/set helper functions
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
-  inline char *GetLogBuffer() { return log_buffer_; }
+  // continue the LSNs of a recovered log, before anything is appended
+  inline void SetNextLSN(lsn_t lsn) {
+    tail_ = static_cast<uint64_t>(lsn) * RESERVE_LSN;
+    persistent_lsn_ = lsn - 1;
+  }
+  inline char *GetLogBuffer() { return buffers_[TailBuffer(tail_)]; }
 
 private:
-  // TODO: you may add your own member variables
-  // also remember to change constructor accordingly
+  // tail_ is the next LSN (bits 33 and up), the buffer appended to (bit 32)
+  // and the bytes reserved in it (low 32 bits); a reservation adds
+  // RESERVE_LSN + size. Once a record does not fit, the offset stays beyond
+  // LOG_BUFFER_SIZE until the buffers are swapped.
+  static const uint64_t RESERVE_LSN = uint64_t(1) << 33;
+  static const uint64_t OFFSET_MASK = (uint64_t(1) << 32) - 1;
+  static const uint64_t NO_SEAL = ~uint64_t(0);
+  static inline lsn_t TailLSN(uint64_t tail) {
+    return static_cast<lsn_t>(tail >> 33);
+  }
+  static inline int TailBuffer(uint64_t tail) { return (tail >> 32) & 1; }
+  static inline uint64_t TailOffset(uint64_t tail) {
+    return tail & OFFSET_MASK;
+  }
+
+  void FlushThread();
+  // swap the buffers and write the old one, latch_ held on entry and exit
+  void FlushBuffer(std::unique_lock<std::mutex> &lock);
+  // wait until the buffer that did not have room is swapped
+  void WaitForRoom();
+  void SerializeLogRecord(LogRecord &log_record, char *data);
 
-  // atomic counter, record the next log sequence number
-  std::atomic<lsn_t> next_lsn_;
+  std::atomic<uint64_t> tail_;
+  // tail_ as seen by the first record that did not fit, i.e. where the
+  // buffer ends; NO_SEAL until then
+  std::atomic<uint64_t> seal_;
   // log records before & include persistent_lsn_ have been written to disk
   std::atomic<lsn_t> persistent_lsn_;
   // log buffer related
-  char *log_buffer_;
-  char *flush_buffer_;
+  char *buffers_[2];
+  // bytes serialized into each buffer, equals the bytes reserved once all
+  // the appenders are done
+  std::atomic<uint64_t> filled_[2];
   // latch to protect shared member variables
-  std::mutex latch_;
+  mutable std::mutex latch_;
   // flush thread
   std::thread *flush_thread_;
+  bool running_;
+  // someone waits for the records being appended
+  bool flush_requested_;
+  bool flushing_; // the other buffer is being written
   // for notifying flush thread
   std::condition_variable cv_;
+  // notified when the buffers were swapped or persistent_lsn_ moved
+  std::condition_variable flushed_cv_;
   // disk manager
   DiskManager *disk_manager_;
+  // bytes in the log file, and the first LSN and the offset of every flush,
+  // oldest first
+  int64_t log_size_;
+  std::vector<std::pair<lsn_t, int64_t>> flushes_;
 };
 
 } // namespace scudb
@@ -19,15 +19,32 @@
  * | HEADER | tuple_rid | tuple_size | old_tuple_data | tuple_size |
  * | new_tuple_data |
  *------------------------------------------------------------------------------
+ * For delta update type log record, written instead of an update one when it
+ * is smaller, e.g. when a few columns of a wide tuple change (see
+ * tuple_delta.h)
+ *------------------------------------------------------------------------------
+ * | HEADER | tuple_rid | old_size | new_size | range_count | range_offset |
+ * | range_length | range_xor_data | ... |
+ *------------------------------------------------------------------------------
  * For new page type log record
  *-------------------------------------------------------------
- * | HEADER | prev_page_id |
+ * | HEADER | prev_page_id | page_id |
  *-------------------------------------------------------------
+ * For end checkpoint type log record (begin checkpoint has no body), the
+ * active transactions with their last LSN and the dirty pages with their
+ * recLSN
+ *------------------------------------------------------------------------------
+ * | HEADER | txn_count | txn_id | last_lsn | ... | page_count | page_id |
+ * | rec_lsn | ... |
+ *------------------------------------------------------------------------------
  */
 #pragma once
 #include <cassert>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "logging/tuple_delta.h"
 #include "table/tuple.h"
 
 namespace scudb {
@@ -44,6 +61,11 @@ enum class LogRecordType {
   ABORT,
   // when create a new page in heap table
   NEWPAGE,
+  // fuzzy checkpoint, see CheckpointManager
+  BEGIN_CHECKPOINT,
+  END_CHECKPOINT,
+  // update with only the changed bytes
+  DELTA_UPDATE,
 };
 
 class LogRecord {
@@ -55,7 +77,7 @@ public:
       : size_(0), lsn_(INVALID_LSN), txn_id_(INVALID_TXN_ID),
         prev_lsn_(INVALID_LSN), log_record_type_(LogRecordType::INVALID) {}
 
-  // constructor for Transaction type(BEGIN/COMMIT/ABORT)
+  // constructor for Transaction type(BEGIN/COMMIT/ABORT) and BEGIN_CHECKPOINT
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type)
       : size_(HEADER_SIZE), lsn_(INVALID_LSN), txn_id_(txn_id),
         prev_lsn_(prev_lsn), log_record_type_(log_record_type) {}
@@ -79,26 +101,48 @@ public:
     size_ = HEADER_SIZE + sizeof(RID) + sizeof(int32_t) + tuple.GetLength();
   }
 
-  // constructor for UPDATE type
+  // constructor for UPDATE type, which becomes a DELTA_UPDATE one if that
+  // is smaller, unless allow_delta is false
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type,
             const RID &update_rid, const Tuple &old_tuple,
-            const Tuple &new_tuple)
+            const Tuple &new_tuple, bool allow_delta = true)
       : lsn_(INVALID_LSN), txn_id_(txn_id), prev_lsn_(prev_lsn),
         log_record_type_(log_record_type), update_rid_(update_rid),
         old_tuple_(old_tuple), new_tuple_(new_tuple) {
     // calculate log record size
     size_ = HEADER_SIZE + sizeof(RID) + old_tuple.GetLength() +
             new_tuple.GetLength() + 2 * sizeof(int32_t);
+    if (allow_delta) {
+      TupleDelta delta(old_tuple, new_tuple);
+      int32_t delta_size = HEADER_SIZE + sizeof(RID) + delta.GetSize();
+      if (delta_size < size_) {
+        log_record_type_ = LogRecordType::DELTA_UPDATE;
+        update_delta_ = delta;
+        size_ = delta_size;
+      }
+    }
   }
 
-  // constructor for NEWPAGE type
+  // constructor for NEWPAGE type, page_id is the new page, redo needs it
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type,
-            page_id_t page_id)
+            page_id_t prev_page_id, page_id_t page_id)
       : size_(HEADER_SIZE), lsn_(INVALID_LSN), txn_id_(txn_id),
         prev_lsn_(prev_lsn), log_record_type_(log_record_type),
-        prev_page_id_(page_id) {
+        prev_page_id_(prev_page_id), page_id_(page_id) {
+    // calculate log record size
+    size_ = HEADER_SIZE + 2 * sizeof(page_id_t);
+  }
+
+  // constructor for END_CHECKPOINT type
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type,
+            const std::vector<std::pair<txn_id_t, lsn_t>> &active_txns,
+            const std::vector<std::pair<page_id_t, lsn_t>> &dirty_pages)
+      : lsn_(INVALID_LSN), txn_id_(txn_id), prev_lsn_(prev_lsn),
+        log_record_type_(log_record_type), active_txns_(active_txns),
+        dirty_pages_(dirty_pages) {
     // calculate log record size
-    size_ = HEADER_SIZE + sizeof(page_id_t);
+    size_ = HEADER_SIZE + 2 * sizeof(int32_t) +
+            (active_txns.size() + dirty_pages.size()) * 2 * sizeof(int32_t);
   }
 
   ~LogRecord() {}
@@ -111,6 +155,16 @@ public:
 
   inline page_id_t GetNewPageRecord() { return prev_page_id_; }
 
+  inline page_id_t GetNewPageId() { return page_id_; }
+
+  inline std::vector<std::pair<txn_id_t, lsn_t>> &GetActiveTxns() {
+    return active_txns_;
+  }
+
+  inline std::vector<std::pair<page_id_t, lsn_t>> &GetDirtyPages() {
+    return dirty_pages_;
+  }
+
   inline int32_t GetSize() { return size_; }
 
   inline lsn_t GetLSN() { return lsn_; }
@@ -155,9 +209,16 @@ private:
   RID update_rid_;
   Tuple old_tuple_;
   Tuple new_tuple_;
+  // only these for delta update
+  TupleDelta update_delta_;
 
   // case4: for new page opeartion
   page_id_t prev_page_id_ = INVALID_PAGE_ID;
+  page_id_t page_id_ = INVALID_PAGE_ID;
+
+  // case5: for end checkpoint
+  std::vector<std::pair<txn_id_t, lsn_t>> active_txns_;
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages_;
   const static int HEADER_SIZE = 20;
 }; // namespace scudb
 
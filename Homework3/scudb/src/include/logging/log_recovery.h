@@ -5,23 +5,46 @@
 
 #pragma once
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
+#include "logging/checkpoint_manager.h"
 #include "logging/log_record.h"
 
 namespace scudb {
 
+/*
+ * Redo reads the log once, front to back, and hands the records on to
+ * num_workers threads: the records of a page always go to the same thread,
+ * so every page replays in LSN order while different pages replay in
+ * parallel. Undo then rolls back the transactions without a COMMIT or ABORT
+ * record, newest change first. With a master record in the header page
+ * (see CheckpointManager), redo starts where the last checkpoint says and
+ * skips the records before the checkpoint that are on disk already, as its
+ * dirty page table tells, without fetching their pages. Logging must be off (ENABLE_LOGGING) while
+ * recovering; undo writes no compensation records, so recovery should be
+ * completed and the pages flushed before new transactions start.
+ */
 class LogRecovery {
 public:
   LogRecovery(DiskManager *disk_manager,
-                    BufferPoolManager *buffer_pool_manager)
+                    BufferPoolManager *buffer_pool_manager,
+                    int num_workers = LOG_RECOVERY_THREADS)
       : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager),
-        offset_(0) {
+        num_workers_(std::max(num_workers, 1)), redo_failed_(false),
+        next_lsn_(0),
+        checkpoint_lsn_(INVALID_LSN), offset_(0) {
     // global transaction through recovery phase
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
+    log_buffer_ = new char[LOG_RECOVERY_READ_SIZE];
   }
 
   ~LogRecovery() {
@@ -29,21 +52,50 @@ public:
     log_buffer_ = nullptr;
   }
 
-  void Redo();
-  void Undo();
+  // false if a record could not be replayed, because its page could not be
+  // fetched or does not match the log; the other records are replayed still
+  bool Redo();
+  bool Undo();
   bool DeserializeLogRecord(const char *data, LogRecord &log_record);
+  // the LSN after the last record found by Redo(), where logging goes on
+  inline lsn_t GetNextLSN() const { return next_lsn_; }
 
 private:
-  // TODO: you can add whatever member variable here
-  // Don't forget to initialize newly added variable in constructor
+  typedef std::vector<std::unique_ptr<LogRecord>> RedoBatch;
+  // the records of one redo thread, handed over in batches
+  struct RedoQueue {
+    std::mutex latch;
+    std::condition_variable cv;
+    std::deque<RedoBatch> batches;
+    bool done = false;
+  };
+
+  int WorkerOf(page_id_t page_id) const { return page_id % num_workers_; }
+  void Dispatch(std::vector<RedoBatch> &pending, bool force);
+  void RedoWorker(int worker);
+  bool RedoRecord(int worker, LogRecord &log_record);
+  bool UndoRecord(LogRecord &log_record);
+  bool ReadCheckpoint(const MasterRecord &master);
+  bool NeedsRedo(const LogRecord &log_record, page_id_t page_id) const;
+
   DiskManager *disk_manager_;
   BufferPoolManager *buffer_pool_manager_;
+  int num_workers_;
+  std::vector<std::unique_ptr<RedoQueue>> queues_;
+  std::atomic<bool> redo_failed_; // a redo thread skipped a record
+  lsn_t next_lsn_;
+  // the last checkpoint: the LSN of its BEGIN_CHECKPOINT record
+  // (INVALID_LSN if there is none), its active transactions and the oldest
+  // recLSN of each of its dirty pages
+  lsn_t checkpoint_lsn_;
+  std::unordered_set<txn_id_t> checkpoint_txns_;
+  std::unordered_map<page_id_t, lsn_t> checkpoint_pages_;
   // maintain active transactions and its corresponds latest lsn
   std::unordered_map<txn_id_t, lsn_t> active_txn_;
   // mapping log sequence number to log file offset, for undo purpose
-  std::unordered_map<lsn_t, int> lsn_mapping_;
+  std::unordered_map<lsn_t, int64_t> lsn_mapping_;
   // log buffer related
-  int offset_;
+  int64_t offset_; // file offset of log_buffer_
   char *log_buffer_;
 };
 
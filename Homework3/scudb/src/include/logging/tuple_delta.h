@@ -0,0 +1,50 @@
+/**
+ * tuple_delta.h
+ * The difference between the old and the new image of an updated tuple, as
+ * the XOR of the byte ranges that changed. The shorter image counts as
+ * padded with zeroes, so the same delta turns the old image into the new
+ * one for redo and the new one back into the old one for undo. Ranges closer
+ * than a range header are merged.
+ * Format (size in byte):
+ *------------------------------------------------------------------------------
+ * | old_size (4) | new_size (4) | range_count (4) | offset (2) | length (2) |
+ * | xor_data (length) | ... |
+ *------------------------------------------------------------------------------
+ */
+
+#pragma once
+#include <vector>
+
+#include "table/tuple.h"
+
+namespace scudb {
+
+class TupleDelta {
+public:
+  TupleDelta() : old_size_(0), new_size_(0), range_count_(0) {}
+  TupleDelta(const Tuple &old_tuple, const Tuple &new_tuple);
+
+  // size of the serialized delta in byte
+  inline int32_t GetSize() const {
+    return 3 * sizeof(int32_t) + static_cast<int32_t>(ranges_.size());
+  }
+  void SerializeTo(char *storage) const;
+  // false if the size bytes at storage are not a consistent delta
+  bool DeserializeFrom(const char *storage, int32_t size);
+
+  // false if the given image is not of the size the delta was made for
+  bool Redo(const Tuple &old_tuple, Tuple &new_tuple) const;
+  bool Undo(const Tuple &new_tuple, Tuple &old_tuple) const;
+
+private:
+  bool Apply(const Tuple &from, int32_t from_size, int32_t to_size,
+             Tuple &to) const;
+
+  int32_t old_size_;
+  int32_t new_size_;
+  int32_t range_count_;
+  // offset, length and xor data of every range
+  std::vector<char> ranges_;
+};
+
+} // namespace scudb
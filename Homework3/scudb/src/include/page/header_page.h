@@ -3,25 +3,44 @@
  *
  * Database use the first page (page_id = 0) as header page to store metadata, in
  * our case, we will contain information about table/index name (length less than
- * 32 bytes) and their corresponding root_id
+ * 32 bytes) and their corresponding root_id, as well as the page size of the
+ * database, which the disk manager reads when the database is opened, and the
+ * master record of the last checkpoint (see CheckpointManager)
  *
  * Format (size in byte):
- *  -----------------------------------------------------------------
- * | RecordCount (4) | Entry_1 name (32) | Entry_1 root_id (4) | ... |
- *  -----------------------------------------------------------------
+ *  ----------------------------------------------------------------------
+ * | RecordCount (4) | LSN (4) | PageSize (4) | CheckpointLSN (4) |
+ *  ----------------------------------------------------------------------
+ * | CheckpointOffset (8) | RedoOffset (8) | Entry_1 name (32) |
+ *  ----------------------------------------------------------------------
+ * | Entry_1 root_id (4) | ... |
+ *  ----------------------------------------------------------------------
  */
 
 #pragma once
 
 #include "page/page.h"
 
+#include <cstdint>
 #include <cstring>
 
 namespace scudb {
 
 class HeaderPage : public Page {
 public:
-  void Init() { SetRecordCount(0); }
+  static const int PAGE_SIZE_OFFSET = 8;
+  static const int MASTER_RECORD_OFFSET = 12;
+  static const int RECORDS_OFFSET = 32;
+
+  void Init() {
+    SetRecordCount(0);
+    int page_size = GetPageSize();
+    memcpy(GetData() + PAGE_SIZE_OFFSET, &page_size, 4);
+    SetMasterRecord(INVALID_LSN, 0, 0);
+  }
+  // whether the page looks like Init() was called on it, e.g. before
+  // reading entries from page 0 of a database that may not have a header
+  bool IsInitialized();
   /**
    * Record related
    */
@@ -33,6 +52,14 @@ public:
   bool GetRootId(const std::string &name, page_id_t &root_id);
   int GetRecordCount();
 
+  /**
+   * Master record related, false if no checkpoint was taken yet
+   */
+  void SetMasterRecord(lsn_t checkpoint_lsn, int64_t checkpoint_offset,
+                       int64_t redo_offset);
+  bool GetMasterRecord(lsn_t &checkpoint_lsn, int64_t &checkpoint_offset,
+                       int64_t &redo_offset);
+
 private:
   /**
    * helper functions
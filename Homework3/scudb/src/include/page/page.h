@@ -8,6 +8,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
 #include <iostream>
 
@@ -20,14 +23,16 @@ class Page {
   friend class BufferPoolManager;
 
 public:
-  Page() { ResetMemory(); }
+  Page() {}
   ~Page(){};
   // get actual data page content
   inline char *GetData() { return data_; }
+  // get size of the data page in byte
+  inline int GetPageSize() { return page_size_; }
   // get page id
   inline page_id_t GetPageId() { return page_id_; }
   // get page pin count
-  inline int GetPinCount() { return pin_count_; }
+  inline int GetPinCount() { return std::max(pin_count_.load(), 0); }
   // method use to latch/unlatch page content
   inline void WUnlatch() { rwlatch_.WUnlock(); }
   inline void WLatch() { rwlatch_.WLock(); }
@@ -35,17 +40,43 @@ public:
   inline void RLatch() { rwlatch_.RLock(); }
 
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + 4); }
-  inline void SetLSN(lsn_t lsn) { memcpy(GetData() + 4, &lsn, 4); }
+  // the first LSN set since the page was last written is its recLSN, see
+  // BufferPoolManager::GetDirtyPageTable()
+  inline void SetLSN(lsn_t lsn) {
+    memcpy(GetData() + 4, &lsn, 4);
+    lsn_t no_lsn = INVALID_LSN;
+    rec_lsn_.compare_exchange_strong(no_lsn, lsn);
+  }
 
 private:
   // method used by buffer pool manager
-  inline void ResetMemory() { memset(data_, 0, PAGE_SIZE); }
+  inline void ResetMemory() { memset(data_, 0, page_size_); }
   // members
-  char data_[PAGE_SIZE]; // actual data
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  int pin_count_ = 0;
-  bool is_dirty_ = false;
+  // the bookkeeping the buffer pool scans comes first and fits into one
+  // cache line; the latches, which are large, follow it, and the data itself
+  // lives in the frame arena of the pool
+  // page_id_, pin_count_, is_dirty_ and is_loading_ are atomic since a hit
+  // in the buffer pool pins the page without taking the pool latch; all
+  // other changes happen with the latch held
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  // -1 while the buffer pool owns the frame (free, or being given a new page)
+  std::atomic<int> pin_count_{0};
+  std::atomic<bool> is_dirty_{false};
+  // disk I/O in progress
+  std::atomic<bool> is_loading_{false}; // contents are being read in, page not usable yet
+  bool is_flushing_ = false;            // contents are being written out
+  int page_size_ = PAGE_SIZE;
+  // actual data, page size aligned memory assigned by the buffer pool
+  char *data_ = nullptr;
+  // LSN of the first change logged since the contents were handed to a
+  // write; while that write is in progress its page and recLSN are kept in
+  // write_page_id_ and write_rec_lsn_, with the latch of the pool held
+  std::atomic<lsn_t> rec_lsn_{INVALID_LSN};
+  page_id_t write_page_id_ = INVALID_PAGE_ID;
+  lsn_t write_rec_lsn_ = INVALID_LSN;
   RWMutex rwlatch_;
+  // notified when is_loading_ or is_flushing_ is cleared
+  std::condition_variable io_cv_;
 };
 
 } // namespace scudb
@@ -49,6 +49,9 @@ public:
   bool InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn,
                    LockManager *lock_manager,
                    LogManager *log_manager); // return rid if success
+  // put tuple into the slot of rid, which must be empty or the next new one;
+  // for recovery, so neither locked nor logged
+  bool InsertTupleAt(const Tuple &tuple, const RID &rid);
   bool MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager,
                   LogManager *log_manager); // delete
   bool UpdateTuple(const Tuple &new_tuple, Tuple &old_tuple, const RID &rid,
@@ -52,6 +52,18 @@ public:
 
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  // number of pages a scan prefetches ahead of its position, 0 disables; a
+  // bulk read stays one page below the ring size of the buffer pool
+  inline void SetPrefetchWindow(int prefetch_window) {
+    prefetch_window_ = prefetch_window;
+  }
+
+  // how a scan reads pages that are not resident, by default it recycles a
+  // small ring of frames so that it cannot flush the whole buffer pool
+  inline void SetScanStrategy(AccessStrategy scan_strategy) {
+    scan_strategy_ = scan_strategy;
+  }
+
 private:
   /**
    * Members
@@ -60,6 +72,8 @@ private:
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_;
+  int prefetch_window_ = TABLE_SCAN_PREFETCH_WINDOW;
+  AccessStrategy scan_strategy_ = AccessStrategy::BULK_READ;
 };
 
 } // namespace scudb
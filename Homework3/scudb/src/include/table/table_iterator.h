@@ -40,9 +40,15 @@ public:
   TableIterator operator++(int);
 
 private:
+  void ReadAhead(int advanced, page_id_t page_id, page_id_t next_page_id);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  // last page handed to PrefetchPages, and how many pages past the current
+  // one have been handed so far
+  page_id_t read_ahead_page_id_ = INVALID_PAGE_ID;
+  int read_ahead_ = 0;
 };
 
 } // namespace scudb
\ No newline at end of file
@@ -31,6 +31,9 @@ bool BPLUSTREE_TYPE::IsEmpty() const {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 thread_local int BPlusTree<KeyType, ValueType, KeyComparator>::rootLockedCnt = 0;
+template <typename KeyType, typename ValueType, typename KeyComparator>
+thread_local std::vector<std::pair<page_id_t, Page *>>
+    BPlusTree<KeyType, ValueType, KeyComparator>::reservedPages;
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
@@ -43,15 +46,14 @@ INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key,
                               std::vector<ValueType> &result,
                               Transaction *transaction) {
-  B_PLUS_TREE_LEAF_PAGE_TYPE *tar = FindLeafPage(key,false,OpType::READ,transaction);
-  if(tar != nullptr)
+  ReadPageGuard guard = FindLeafPageRead(key);
+  if (guard)
   {
+      auto tar = reinterpret_cast<const B_PLUS_TREE_LEAF_PAGE_TYPE *>(guard.GetData());
       result.resize(1);
 
       // put the value in the result and return
-      auto ret = tar->Lookup(key,result[0],comparator_);
-      FreePagesInTransaction(false,transaction,tar->GetPageId());
-      return ret;
+      return tar->Lookup(key,result[0],comparator_);
   }
   return false;
 }
@@ -93,18 +95,22 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
   page_id_t newPageId;
   Page *rootPage = buffer_pool_manager_->NewPage(newPageId);
-  assert(rootPage != nullptr);
+  if (rootPage == nullptr) {
+    TryUnlockRootPageId(true);
+    throw Exception(EXCEPTION_TYPE_INDEX, "out of memory while starting a new tree");
+  }
+  BasicPageGuard guard(buffer_pool_manager_, rootPage);
 
   // convert the struct Page into the struct B_PLUS_TREE_LEAF_PAGE_TYPE
   B_PLUS_TREE_LEAF_PAGE_TYPE *root = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(rootPage->GetData());
 
-  root->Init(newPageId,INVALID_PAGE_ID);
+  root->Init(newPageId,INVALID_PAGE_ID,rootPage->GetPageSize());
   root_page_id_ = newPageId;
   UpdateRootPageId(true);
   root->Insert(key,value,comparator_);
 
-  // unpin this page and mark it dirty
-  buffer_pool_manager_->UnpinPage(newPageId,true);
+  // the guard unpins this page
+  guard.MarkDirty();
 }
 
 /*
@@ -112,6 +118,9 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
  * User needs to first find the right leaf page as insertion target, then look
  * through leaf page to see whether insert key exist or not. If exist, return
  * immdiately, otherwise insert entry. Remember to deal with split if necessary.
+ * The pages a split needs are reserved before the leaf is changed: every
+ * page still latched may split, plus a new root. If the buffer pool runs out
+ * of frames the tree is left as it was and an exception is thrown.
  * @return: since we only support unique key, if user try to insert duplicate
  * keys return false, otherwise return true.
  */
@@ -126,6 +135,12 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
     FreePagesInTransaction(true,transaction);
     return false;
   }
+  if (leafPage->GetSize() >= leafPage->GetMaxSize() &&
+      !ReserveNewPages(transaction->GetPageSet()->size() + 1))
+  {
+    FreePagesInTransaction(true,transaction);
+    throw Exception(EXCEPTION_TYPE_INDEX, "out of memory while splitting");
+  }
   leafPage->Insert(key,value,comparator_);
   if (leafPage->GetSize() > leafPage->GetMaxSize())
   {// overflow, then split
@@ -133,6 +148,7 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
     InsertIntoParent(leafPage,newLeafPage->KeyAt(0),newLeafPage,transaction);
   }
   FreePagesInTransaction(true,transaction);
+  ReleaseReservedPages();
   return true;
 }
 
@@ -142,16 +158,16 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
+ * The new page comes from the pages reserved by InsertIntoLeaf.
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N> N *BPLUSTREE_TYPE::Split(N *node, Transaction *transaction) {
   page_id_t newPageId;
-  Page* const newPage = buffer_pool_manager_->NewPage(newPageId);
-  assert(newPage != nullptr);
+  Page* const newPage = TakeReservedPage(newPageId);
   newPage->WLatch();
   transaction->AddIntoPageSet(newPage);
   N *newNode = reinterpret_cast<N *>(newPage->GetData());
-  newNode->Init(newPageId, node->GetParentPageId());
+  newNode->Init(newPageId, node->GetParentPageId(), newPage->GetPageSize());
   node->MoveHalfTo(newNode, buffer_pool_manager_);
   return newNode;
 }
@@ -172,22 +188,25 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node,
                                       Transaction *transaction) {
   if (old_node->IsRootPage())
   {
-    Page* const newPage = buffer_pool_manager_->NewPage(root_page_id_);
-    assert(newPage != nullptr);
+    Page* const newPage = TakeReservedPage(root_page_id_);
     assert(newPage->GetPinCount() == 1);
+    BasicPageGuard guard(buffer_pool_manager_, newPage);
     B_PLUS_TREE_INTERNAL_PAGE *newRoot = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE *>(newPage->GetData());
-    newRoot->Init(root_page_id_);
+    newRoot->Init(root_page_id_, INVALID_PAGE_ID, newPage->GetPageSize());
     newRoot->PopulateNewRoot(old_node->GetPageId(),key,new_node->GetPageId());
     old_node->SetParentPageId(root_page_id_);
     new_node->SetParentPageId(root_page_id_);
     UpdateRootPageId();
-    buffer_pool_manager_->UnpinPage(newRoot->GetPageId(),true);
+    guard.MarkDirty();
     return;
   }
+  // the parent is latched already, it is in the page set of the transaction
   page_id_t parentId = old_node->GetParentPageId();
-  auto *page = FetchPage(parentId);
-  assert(page != nullptr);
-  B_PLUS_TREE_INTERNAL_PAGE *parent = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE *>(page);
+  BasicPageGuard guard(buffer_pool_manager_, buffer_pool_manager_->FetchPage(parentId));
+  if (!guard) {
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while InsertIntoParent");
+  }
+  B_PLUS_TREE_INTERNAL_PAGE *parent = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE *>(guard.GetData());
   new_node->SetParentPageId(parentId);
   parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
   if (parent->GetSize() > parent->GetMaxSize())
@@ -195,7 +214,7 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node,
     B_PLUS_TREE_INTERNAL_PAGE *newLeafPage = Split(parent,transaction);//new page need unpin
     InsertIntoParent(parent,newLeafPage->KeyAt(0),newLeafPage,transaction);
   }
-  buffer_pool_manager_->UnpinPage(parentId,true);
+  guard.MarkDirty();
 }
 
 /*****************************************************************************
@@ -243,8 +262,8 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
   }
   N *node2;
   bool isRightSib = FindLeftSibling(node,node2,transaction);
-  BPlusTreePage *parent = FetchPage(node->GetParentPageId());
-  B_PLUS_TREE_INTERNAL_PAGE *parentPage = static_cast<B_PLUS_TREE_INTERNAL_PAGE *>(parent);
+  BasicPageGuard guard(buffer_pool_manager_, buffer_pool_manager_->FetchPage(node->GetParentPageId()));
+  B_PLUS_TREE_INTERNAL_PAGE *parentPage = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE *>(guard.GetData());
   if (node->GetSize() + node2->GetSize() <= node->GetMaxSize())
   {// if the sum size < max size, coalesce two node
     if (isRightSib)
@@ -253,20 +272,19 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
     }
     int removeIndex = parentPage->ValueIndex(node->GetPageId());
     Coalesce(node2,node,parentPage,removeIndex,transaction);
-    buffer_pool_manager_->UnpinPage(parentPage->GetPageId(), true);
+    guard.MarkDirty();
     return true;
   }
   int nodeInParentIndex = parentPage->ValueIndex(node->GetPageId());
   Redistribute(node2,node,nodeInParentIndex);
-  buffer_pool_manager_->UnpinPage(parentPage->GetPageId(), false);
   return false;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::FindLeftSibling(N *node, N * &sibling, Transaction *transaction) {
-  auto page = FetchPage(node->GetParentPageId());
-  B_PLUS_TREE_INTERNAL_PAGE *parent = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE *>(page);
+  BasicPageGuard guard(buffer_pool_manager_, buffer_pool_manager_->FetchPage(node->GetParentPageId()));
+  B_PLUS_TREE_INTERNAL_PAGE *parent = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE *>(guard.GetData());
   int index = parent->ValueIndex(node->GetPageId());
   int siblingIndex = index - 1;
   if (index == 0)
@@ -274,7 +292,6 @@ bool BPLUSTREE_TYPE::FindLeftSibling(N *node, N * &sibling, Transaction *transac
     siblingIndex = index + 1;
   }
   sibling = reinterpret_cast<N *>(CrabingProtocalFetchPage(parent->ValueAt(siblingIndex),OpType::DELETE,-1,transaction));
-  buffer_pool_manager_->UnpinPage(parent->GetPageId(), false);
   return index == 0;
 }
 
@@ -351,15 +368,18 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
   if (old_root_node->GetSize() == 1)
   {
     B_PLUS_TREE_INTERNAL_PAGE *root = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE *>(old_root_node);
+    // fetch the child first, the tree stays as it is if that fails
+    BasicPageGuard guard(buffer_pool_manager_, buffer_pool_manager_->FetchPage(root->ValueAt(0)));
+    if (!guard) {
+      throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while AdjustRoot");
+    }
     const page_id_t newRootId = root->RemoveAndReturnOnlyChild();
     root_page_id_ = newRootId;
     UpdateRootPageId();
-    Page *page = buffer_pool_manager_->FetchPage(newRootId);
-    assert(page != nullptr);
     B_PLUS_TREE_INTERNAL_PAGE *newRoot =
-            reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE *>(page->GetData());
+            reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE *>(guard.GetData());
     newRoot->SetParentPageId(INVALID_PAGE_ID);
-    buffer_pool_manager_->UnpinPage(newRootId, true);
+    guard.MarkDirty();
     return true;
   }
   return false;
@@ -376,9 +396,7 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
   KeyType useless;
-  auto start_leaf = FindLeafPage(useless, true);
-  TryUnlockRootPageId(false);
-  return INDEXITERATOR_TYPE(start_leaf, 0, buffer_pool_manager_);
+  return INDEXITERATOR_TYPE(FindLeafPageRead(useless, true), 0, buffer_pool_manager_);
 }
 
 /*
@@ -388,27 +406,57 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
-  auto start_leaf = FindLeafPage(key);
-  TryUnlockRootPageId(false);
-  if (start_leaf == nullptr)
+  ReadPageGuard guard = FindLeafPageRead(key);
+  int idx = 0;
+  if (guard)
   {
-    return INDEXITERATOR_TYPE(start_leaf, 0, buffer_pool_manager_);
+    auto start_leaf = reinterpret_cast<const B_PLUS_TREE_LEAF_PAGE_TYPE *>(guard.GetData());
+    idx = start_leaf->KeyIndex(key,comparator_);
   }
-  int idx = start_leaf->KeyIndex(key,comparator_);
-  return INDEXITERATOR_TYPE(start_leaf, idx, buffer_pool_manager_);
+  return INDEXITERATOR_TYPE(std::move(guard), idx, buffer_pool_manager_);
 }
 
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
+/*
+ * Find leaf page containing particular key for reading, if leftMost flag ==
+ * true, find the left most leaf page. Each page is latched before its parent
+ * is released, the returned guard holds the leaf, it is empty if the tree is.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+ReadPageGuard BPLUSTREE_TYPE::FindLeafPageRead(const KeyType &key, bool leftMost) {
+  LockRootPageId(false);
+  if (IsEmpty())
+  {
+    TryUnlockRootPageId(false);
+    return ReadPageGuard();
+  }
+  ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(root_page_id_);
+  // a new root needs the old one latched exclusively
+  TryUnlockRootPageId(false);
+  auto pointer = reinterpret_cast<const BPlusTreePage *>(guard.GetData());
+  while (!pointer->IsLeafPage())
+  {
+    auto internalPage = static_cast<const B_PLUS_TREE_INTERNAL_PAGE *>(pointer);
+    page_id_t next = leftMost ? internalPage->ValueAt(0) : internalPage->Lookup(key,comparator_);
+    // the child is latched before the assignment releases its parent
+    guard = buffer_pool_manager_->FetchPageRead(next);
+    pointer = reinterpret_cast<const BPlusTreePage *>(guard.GetData());
+  }
+  return guard;
+}
+
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
- * the left most leaf page
+ * the left most leaf page. The pages that stay latched are collected in the
+ * page set of transaction and released by FreePagesInTransaction().
  */
 INDEX_TEMPLATE_ARGUMENTS
 B_PLUS_TREE_LEAF_PAGE_TYPE *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key,
                                                          bool leftMost,OpType op,
                                                          Transaction *transaction) {
+  assert(transaction != nullptr);
   bool exclusive = (op != OpType::READ);
   LockRootPageId(exclusive);
   if (IsEmpty())
@@ -433,33 +481,65 @@ B_PLUS_TREE_LEAF_PAGE_TYPE *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key,
   return static_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(pointer);
 }
 INDEX_TEMPLATE_ARGUMENTS
-BPlusTreePage *BPLUSTREE_TYPE::FetchPage(page_id_t page_id) {
-  auto page = buffer_pool_manager_->FetchPage(page_id);
-  return reinterpret_cast<BPlusTreePage *>(page->GetData());
-}
-INDEX_TEMPLATE_ARGUMENTS
 BPlusTreePage *BPLUSTREE_TYPE::CrabingProtocalFetchPage(page_id_t page_id,OpType op,page_id_t previous, Transaction *transaction) {
   bool exclusive = op != OpType::READ;
   auto page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    FreePagesInTransaction(exclusive,transaction);
+    throw Exception(EXCEPTION_TYPE_INDEX,"all page are pinned while crabbing");
+  }
   Lock(exclusive,page);
   auto treePage = reinterpret_cast<BPlusTreePage *>(page->GetData());
   if (previous > 0 && (!exclusive || treePage->IsSafe(op))) {
-    FreePagesInTransaction(exclusive,transaction,previous);
+    FreePagesInTransaction(exclusive,transaction);
   }
-  if (transaction != nullptr)
-    transaction->AddIntoPageSet(page);
+  transaction->AddIntoPageSet(page);
   return treePage;
 }
 
+/*
+ * Get count new pages from the buffer pool for the splits of one insertion,
+ * they stay pinned until taken or released. return false, with nothing
+ * reserved, if the buffer pool runs out of frames
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::FreePagesInTransaction(bool exclusive, Transaction *transaction, page_id_t cur) {
-  TryUnlockRootPageId(exclusive);
-  if (transaction == nullptr) {
-    assert(!exclusive && cur >= 0);
-    Unlock(false,cur);
-    buffer_pool_manager_->UnpinPage(cur,false);
-    return;
+bool BPLUSTREE_TYPE::ReserveNewPages(size_t count) {
+  while (reservedPages.size() < count) {
+    page_id_t pageId;
+    Page *page = buffer_pool_manager_->NewPage(pageId);
+    if (page == nullptr) {
+      ReleaseReservedPages();
+      return false;
+    }
+    reservedPages.emplace_back(pageId, page);
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::TakeReservedPage(page_id_t &page_id) {
+  assert(!reservedPages.empty());
+  Page *page = reservedPages.back().second;
+  page_id = reservedPages.back().first;
+  reservedPages.pop_back();
+  return page;
+}
+
+/*
+ * Give the reserved pages no split needed back to the buffer pool and disk
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseReservedPages() {
+  for (auto &reserved : reservedPages) {
+    buffer_pool_manager_->UnpinPage(reserved.first, false);
+    buffer_pool_manager_->DeletePage(reserved.first);
   }
+  reservedPages.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FreePagesInTransaction(bool exclusive, Transaction *transaction) {
+  TryUnlockRootPageId(exclusive);
   for (Page *page : *transaction->GetPageSet()) {
     int curPid = page->GetPageId();
     Unlock(exclusive,page);
@@ -483,15 +563,15 @@ void BPLUSTREE_TYPE::FreePagesInTransaction(bool exclusive, Transaction *transac
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-    HeaderPage *header_page = static_cast<HeaderPage *>(
-            buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(HEADER_PAGE_ID);
+    HeaderPage *header_page = static_cast<HeaderPage *>(guard.GetPage());
     if (insert_record)
         // create a new record<index_name + root_page_id> in header_page
         header_page->InsertRecord(index_name_, root_page_id_);
     else
         // update root_page_id in header_page
         header_page->UpdateRecord(index_name_, root_page_id_);
-    buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+    guard.MarkDirty();
 }
 
 /*
@@ -576,11 +656,12 @@ void BPLUSTREE_TYPE::RemoveFromFile(const std::string &file_name,
 INDEX_TEMPLATE_ARGUMENTS
 int BPLUSTREE_TYPE::isBalanced(page_id_t pid) {
   if (IsEmpty()) return true;
-  auto node = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(pid));
-  if (node == nullptr)
+  BasicPageGuard guard(buffer_pool_manager_, buffer_pool_manager_->FetchPage(pid));
+  if (!guard)
   {
     throw Exception(EXCEPTION_TYPE_INDEX,"all page are pinned while isBalanced");
   }
+  auto node = reinterpret_cast<BPlusTreePage *>(guard.GetData());
   int res = 0;
   if (!node->IsLeafPage())
   {
@@ -601,18 +682,18 @@ int BPLUSTREE_TYPE::isBalanced(page_id_t pid) {
       }
     }
   }
-  buffer_pool_manager_->UnpinPage(pid,false);
   return res;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::isPageCorr(page_id_t pid,std::pair<KeyType,KeyType> &out) {
   if (IsEmpty()) return true;
-  auto node = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(pid));
-  if (node == nullptr)
+  BasicPageGuard guard(buffer_pool_manager_, buffer_pool_manager_->FetchPage(pid));
+  if (!guard)
   {
     throw Exception(EXCEPTION_TYPE_INDEX,"all page are pinned while isPageCorr");
   }
+  auto node = reinterpret_cast<BPlusTreePage *>(guard.GetData());
   bool res = true;
   if (node->IsLeafPage())
   {
@@ -649,7 +730,6 @@ bool BPLUSTREE_TYPE::isPageCorr(page_id_t pid,std::pair<KeyType,KeyType> &out) {
     }
     out = std::pair<KeyType,KeyType>{page->KeyAt(0),page->KeyAt(size-1)};
   }
-  buffer_pool_manager_->UnpinPage(pid,false);
   return res;
 }
 
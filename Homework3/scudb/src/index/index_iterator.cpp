@@ -12,17 +12,19 @@ namespace scudb {
  * set your own input parameters
  */
     INDEX_TEMPLATE_ARGUMENTS
-    INDEXITERATOR_TYPE::IndexIterator(B_PLUS_TREE_LEAF_PAGE_TYPE *leaf, int index, BufferPoolManager *bufferPoolManager)
-    : index_(index),leaf_(leaf), bufferPoolManager_(bufferPoolManager){}
-
-    INDEX_TEMPLATE_ARGUMENTS
-    INDEXITERATOR_TYPE::~IndexIterator() {
-        if (leaf_ != nullptr)
+    INDEXITERATOR_TYPE::IndexIterator(ReadPageGuard &&guard, int index, BufferPoolManager *bufferPoolManager)
+    : index_(index), guard_(std::move(guard)), leaf_(nullptr), bufferPoolManager_(bufferPoolManager)
+    {
+        if (guard_)
         {
-            UnlockAndUnPin();
+            leaf_ = reinterpret_cast<const B_PLUS_TREE_LEAF_PAGE_TYPE *>(guard_.GetData());
         }
     }
 
+    // the guard unlatches and unpins the current leaf
+    INDEX_TEMPLATE_ARGUMENTS
+    INDEXITERATOR_TYPE::~IndexIterator() {}
+
     INDEX_TEMPLATE_ARGUMENTS
     bool INDEXITERATOR_TYPE::isEnd()
     {
@@ -0,0 +1,131 @@
+/**
+ * checkpoint_manager.cpp
+ */
+
+#include "common/logger.h"
+#include "logging/checkpoint_manager.h"
+#include "page/header_page.h"
+
+namespace scudb {
+
+void CheckpointManager::RunCheckpointThread() {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (checkpoint_thread_ != nullptr) {
+    return;
+  }
+  running_ = true;
+  checkpoint_thread_ = new std::thread(&CheckpointManager::CheckpointThread, this);
+}
+
+void CheckpointManager::StopCheckpointThread() {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (checkpoint_thread_ == nullptr) {
+      return;
+    }
+    running_ = false;
+    cv_.notify_one();
+  }
+  checkpoint_thread_->join();
+  delete checkpoint_thread_;
+  checkpoint_thread_ = nullptr;
+}
+
+void CheckpointManager::CheckpointThread() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    cv_.wait_for(lock, CHECKPOINT_TIMEOUT, [this] { return !running_; });
+    if (!running_) {
+      return;
+    }
+    lock.unlock();
+    Checkpoint();
+    lock.lock();
+  }
+}
+
+/*
+ * The dirty page table is taken after the BEGIN_CHECKPOINT record got its
+ * LSN, so a change whose record is older than that is either in the table
+ * or made by a transaction in the active transaction table, see
+ * BufferPoolManager::GetDirtyPageTable(); recovery redoes both.
+ */
+bool CheckpointManager::Checkpoint() {
+  std::lock_guard<std::mutex> guard(checkpoint_latch_);
+  LogRecord begin_record(INVALID_TXN_ID, INVALID_LSN,
+                         LogRecordType::BEGIN_CHECKPOINT);
+  lsn_t begin_lsn = log_manager_->AppendLogRecord(begin_record);
+
+  std::vector<std::pair<txn_id_t, lsn_t>> active_txns;
+  lsn_t redo_lsn;
+  transaction_manager_->GetActiveTransactions(active_txns, redo_lsn);
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages;
+  buffer_pool_manager_->GetDirtyPageTable(dirty_pages);
+  LogRecord end_record(INVALID_TXN_ID, begin_lsn,
+                       LogRecordType::END_CHECKPOINT, active_txns,
+                       dirty_pages);
+  if (end_record.GetSize() > LOG_BUFFER_SIZE) {
+    LOG_DEBUG("checkpoint: %d dirty pages do not fit into the log buffer",
+              static_cast<int>(dirty_pages.size()));
+    return false;
+  }
+  lsn_t end_lsn = log_manager_->AppendLogRecord(end_record);
+
+  if (redo_lsn == INVALID_LSN || begin_lsn < redo_lsn) {
+    redo_lsn = begin_lsn;
+  }
+  for (auto &page : dirty_pages) {
+    redo_lsn = std::min(redo_lsn, page.second);
+  }
+  // the master record must not point at records that may get lost
+  log_manager_->WaitForFlush(end_lsn);
+  MasterRecord master;
+  master.checkpoint_lsn = end_lsn;
+  master.redo_offset = log_manager_->GetLogOffset(redo_lsn);
+  master.checkpoint_offset = log_manager_->GetLogOffset(end_lsn);
+  if (!WriteMasterRecord(master)) {
+    return false;
+  }
+  // recovery starts at redo_lsn from now on, and so do later checkpoints
+  log_manager_->ForgetLogOffsets(redo_lsn);
+  return true;
+}
+
+/*
+ * The header page is written and synced right away, in one piece, so the
+ * master record is durable once this returns true
+ */
+bool CheckpointManager::WriteMasterRecord(const MasterRecord &master) {
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(HEADER_PAGE_ID);
+  if (!guard) {
+    return false;
+  }
+  auto header_page = static_cast<HeaderPage *>(guard.GetPage());
+  if (!header_page->IsInitialized()) {
+    return false;
+  }
+  header_page->SetMasterRecord(master.checkpoint_lsn, master.checkpoint_offset,
+                               master.redo_offset);
+  guard.MarkDirty();
+  guard.Drop();
+  if (!buffer_pool_manager_->FlushPage(HEADER_PAGE_ID)) {
+    return false;
+  }
+  buffer_pool_manager_->SyncPages();
+  return true;
+}
+
+bool CheckpointManager::ReadMasterRecord(BufferPoolManager *buffer_pool_manager,
+                                         MasterRecord &master) {
+  ReadPageGuard guard = buffer_pool_manager->FetchPageRead(HEADER_PAGE_ID);
+  if (!guard) {
+    return false;
+  }
+  auto header_page = static_cast<HeaderPage *>(guard.GetPage());
+  return header_page->IsInitialized() &&
+         header_page->GetMasterRecord(master.checkpoint_lsn,
+                                      master.checkpoint_offset,
+                                      master.redo_offset);
+}
+
+} // namespace scudb
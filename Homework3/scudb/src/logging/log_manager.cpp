@@ -12,35 +12,270 @@ namespace scudb {
  * manager wants to force flush (it only happens when the flushed page has a
  * larger LSN than persistent LSN)
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  ENABLE_LOGGING = true;
+  running_ = true;
+  flush_thread_ = new std::thread(&LogManager::FlushThread, this);
+}
 /*
  * Stop and join the flush thread, set ENABLE_LOGGING = false
+ * The records appended so far are written before the thread exits
+ */
+void LogManager::StopFlushThread() {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (flush_thread_ == nullptr) {
+      return;
+    }
+    ENABLE_LOGGING = false;
+    running_ = false;
+    cv_.notify_one();
+  }
+  flush_thread_->join();
+  std::thread *flush_thread;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    flush_thread = flush_thread_;
+    flush_thread_ = nullptr;
+  }
+  delete flush_thread;
+}
+
+/*
+ * Wake up every LOG_TIMEOUT, or as soon as someone waits for the records in
+ * the log buffer, and write them as one group
+ */
+void LogManager::FlushThread() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    cv_.wait_for(lock, LOG_TIMEOUT,
+                 [this] { return !running_ || flush_requested_; });
+    // stopped before this flush started, so it takes the last records
+    bool stopping = !running_;
+    FlushBuffer(lock);
+    if (stopping) {
+      return;
+    }
+  }
+}
+
+/*
+ * Swap the buffers, then write the old one once every record reserved in it
+ * is serialized. The swap ends the old buffer where tail_ is, or where the
+ * first record that did not fit was reserved, and keeps the LSN counter, so
+ * the LSNs stay contiguous: reservations made beyond the end are dropped
+ * and tried again by their appenders. Without a running flush thread the
+ * callers take turns.
  */
-void LogManager::StopFlushThread() {}
+void LogManager::FlushBuffer(std::unique_lock<std::mutex> &lock) {
+  while (flushing_) {
+    flushed_cv_.wait(lock);
+  }
+  flush_requested_ = false;
+  uint64_t tail = tail_.load();
+  uint64_t end;
+  while (true) {
+    if (TailOffset(tail) > LOG_BUFFER_SIZE) {
+      // only this latch swaps, the offset grows until then and any
+      // reservation after the seal is invalid
+      while ((end = seal_.load()) == NO_SEAL) {
+        std::this_thread::yield();
+      }
+      seal_ = NO_SEAL;
+      tail_ = (end & ~OFFSET_MASK) ^ (uint64_t(1) << 32);
+      break;
+    }
+    if (TailOffset(tail) == 0) {
+      flushed_cv_.notify_all();
+      return;
+    }
+    if (tail_.compare_exchange_weak(tail,
+                                    (tail & ~OFFSET_MASK) ^ (uint64_t(1) << 32))) {
+      end = tail;
+      break;
+    }
+  }
+  // the appenders waiting for room can go on
+  flushed_cv_.notify_all();
+
+  int buffer = TailBuffer(end);
+  uint64_t size = TailOffset(end);
+  flushing_ = true;
+  lock.unlock();
+  while (filled_[buffer].load() != size) {
+    std::this_thread::yield();
+  }
+  filled_[buffer] = 0;
+  disk_manager_->WriteLog(buffers_[buffer], static_cast<int>(size));
+  lock.lock();
+  flushing_ = false;
+  flushes_.emplace_back(persistent_lsn_ + 1, log_size_);
+  log_size_ += static_cast<int64_t>(size);
+  persistent_lsn_ = TailLSN(end) - 1;
+  flushed_cv_.notify_all();
+}
 
 /*
  * append a log record into log buffer
  * you MUST set the log record's lsn within this method
  * @return: lsn that is assigned to this log record
- *
- *
- * example below
- * // First, serialize the must have fields(20 bytes in total)
- * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
- *
- * if (log_record.log_record_type_ == LogRecordType::INSERT) {
- *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
- *    pos += sizeof(RID);
- *    // we have provided serialize function for tuple class
- *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
- *  }
- *
+ * One fetch-add reserves the LSN and the bytes, so the LSN order is the
+ * order in the buffer and on disk. The record is serialized without any
+ * latch and published through filled_. If it does not fit, wait for the
+ * buffers to be swapped and reserve again.
  */
 lsn_t LogManager::AppendLogRecord(LogRecord &log_record) {
+  assert(log_record.size_ <= LOG_BUFFER_SIZE);
+  uint64_t size = log_record.size_;
+  while (true) {
+    uint64_t tail = tail_.fetch_add(RESERVE_LSN + size);
+    uint64_t offset = TailOffset(tail);
+    if (offset + size <= LOG_BUFFER_SIZE) {
+      int buffer = TailBuffer(tail);
+      log_record.lsn_ = TailLSN(tail);
+      SerializeLogRecord(log_record, buffers_[buffer] + offset);
+      filled_[buffer].fetch_add(size);
+      return log_record.lsn_;
+    }
+    if (offset <= LOG_BUFFER_SIZE) {
+      // the first one that does not fit, the buffer ends here
+      seal_ = tail;
+    }
+    WaitForRoom();
+  }
+}
+
+void LogManager::WaitForRoom() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (TailOffset(tail_.load()) > LOG_BUFFER_SIZE) {
+    if (flush_thread_ == nullptr || !running_) {
+      FlushBuffer(lock);
+      continue;
+    }
+    flush_requested_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(lock);
+  }
+}
 
-  return INVALID_LSN;
+/*
+ * Records that are not assigned yet can not be waited for; an LSN read from
+ * a page that does not store one (e.g. the header page) is clamped that way
+ * and costs one flush at most.
+ */
+void LogManager::WaitForFlush(lsn_t lsn) {
+  if (lsn <= persistent_lsn_) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(latch_);
+  lsn = std::min(lsn, TailLSN(tail_.load()) - 1);
+  while (persistent_lsn_ < lsn) {
+    if (flush_thread_ == nullptr || !running_) {
+      FlushBuffer(lock);
+      continue;
+    }
+    flush_requested_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(lock);
+  }
+}
+
+/*
+ * The offset of the last flush that starts at or before lsn
+ */
+int64_t LogManager::GetLogOffset(lsn_t lsn) const {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = std::upper_bound(
+      flushes_.begin(), flushes_.end(), lsn,
+      [](lsn_t lsn, const std::pair<lsn_t, int64_t> &flush) {
+        return lsn < flush.first;
+      });
+  if (it == flushes_.begin()) {
+    return 0;
+  }
+  return (--it)->second;
+}
+
+/*
+ * Drop the flushes before the one that has the record of lsn, GetLogOffset()
+ * still finds it and every later one
+ */
+void LogManager::ForgetLogOffsets(lsn_t lsn) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = std::upper_bound(
+      flushes_.begin(), flushes_.end(), lsn,
+      [](lsn_t lsn, const std::pair<lsn_t, int64_t> &flush) {
+        return lsn < flush.first;
+      });
+  if (it != flushes_.begin()) {
+    flushes_.erase(flushes_.begin(), --it);
+  }
+}
+
+/*
+ * Serialize the must have fields (20 bytes in total), followed by the body
+ * of the record type, see log_record.h
+ */
+void LogManager::SerializeLogRecord(LogRecord &log_record, char *data) {
+  memcpy(data, &log_record, LogRecord::HEADER_SIZE);
+  int pos = LogRecord::HEADER_SIZE;
+  switch (log_record.log_record_type_) {
+  case LogRecordType::INSERT:
+    memcpy(data + pos, &log_record.insert_rid_, sizeof(RID));
+    pos += sizeof(RID);
+    log_record.insert_tuple_.SerializeTo(data + pos);
+    break;
+  case LogRecordType::MARKDELETE:
+  case LogRecordType::APPLYDELETE:
+  case LogRecordType::ROLLBACKDELETE:
+    memcpy(data + pos, &log_record.delete_rid_, sizeof(RID));
+    pos += sizeof(RID);
+    log_record.delete_tuple_.SerializeTo(data + pos);
+    break;
+  case LogRecordType::UPDATE:
+    memcpy(data + pos, &log_record.update_rid_, sizeof(RID));
+    pos += sizeof(RID);
+    log_record.old_tuple_.SerializeTo(data + pos);
+    pos += sizeof(int32_t) + log_record.old_tuple_.GetLength();
+    log_record.new_tuple_.SerializeTo(data + pos);
+    break;
+  case LogRecordType::DELTA_UPDATE:
+    memcpy(data + pos, &log_record.update_rid_, sizeof(RID));
+    pos += sizeof(RID);
+    log_record.update_delta_.SerializeTo(data + pos);
+    break;
+  case LogRecordType::NEWPAGE:
+    memcpy(data + pos, &log_record.prev_page_id_, sizeof(page_id_t));
+    pos += sizeof(page_id_t);
+    memcpy(data + pos, &log_record.page_id_, sizeof(page_id_t));
+    break;
+  case LogRecordType::END_CHECKPOINT: {
+    int32_t count = static_cast<int32_t>(log_record.active_txns_.size());
+    memcpy(data + pos, &count, sizeof(int32_t));
+    pos += sizeof(int32_t);
+    for (auto &txn : log_record.active_txns_) {
+      memcpy(data + pos, &txn.first, sizeof(txn_id_t));
+      memcpy(data + pos + sizeof(txn_id_t), &txn.second, sizeof(lsn_t));
+      pos += sizeof(txn_id_t) + sizeof(lsn_t);
+    }
+    count = static_cast<int32_t>(log_record.dirty_pages_.size());
+    memcpy(data + pos, &count, sizeof(int32_t));
+    pos += sizeof(int32_t);
+    for (auto &page : log_record.dirty_pages_) {
+      memcpy(data + pos, &page.first, sizeof(page_id_t));
+      memcpy(data + pos + sizeof(page_id_t), &page.second, sizeof(lsn_t));
+      pos += sizeof(page_id_t) + sizeof(lsn_t);
+    }
+    break;
+  }
+  default:
+    // BEGIN/COMMIT/ABORT/BEGIN_CHECKPOINT have no body
+    break;
+  }
 }
 
 } // namespace scudb
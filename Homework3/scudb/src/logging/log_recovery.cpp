@@ -2,18 +2,148 @@
  * log_recovey.cpp
  */
 
+#include <queue>
+
 #include "logging/log_recovery.h"
 #include "page/table_page.h"
 
 namespace scudb {
+// records handed to a redo thread at once, and batches queued per thread
+// before the reading thread waits
+static const size_t REDO_BATCH_SIZE = 256;
+static const size_t REDO_MAX_BATCHES = 64;
+
 /*
  * deserialize a log record from log buffer
  * @return: true means deserialize succeed, otherwise can't deserialize cause
  * incomplete log record
+ * data points into log_buffer_, a record must end within the buffer and be
+ * consistent with its size, which also stops at the zeroes read past the end
+ * of the log file
  */
 bool LogRecovery::DeserializeLogRecord(const char *data,
                                              LogRecord &log_record) {
-  return false;
+  long available = log_buffer_ + LOG_RECOVERY_READ_SIZE - data;
+  if (available < LogRecord::HEADER_SIZE) {
+    return false;
+  }
+  int32_t size;
+  memcpy(&size, data, sizeof(int32_t));
+  if (size < LogRecord::HEADER_SIZE || size > available ||
+      size > LOG_BUFFER_SIZE) {
+    return false;
+  }
+  int32_t type;
+  memcpy(&type, data + 16, sizeof(int32_t));
+  if (type <= static_cast<int32_t>(LogRecordType::INVALID) ||
+      type > static_cast<int32_t>(LogRecordType::DELTA_UPDATE)) {
+    return false;
+  }
+  log_record.size_ = size;
+  memcpy(&log_record.lsn_, data + 4, sizeof(lsn_t));
+  memcpy(&log_record.txn_id_, data + 8, sizeof(txn_id_t));
+  memcpy(&log_record.prev_lsn_, data + 12, sizeof(lsn_t));
+  log_record.log_record_type_ = static_cast<LogRecordType>(type);
+
+  // a tuple is its size followed by the data, see Tuple::SerializeTo()
+  int32_t pos = LogRecord::HEADER_SIZE;
+  auto read_tuple = [&](Tuple &tuple) {
+    int32_t tuple_size;
+    if (pos + static_cast<int32_t>(sizeof(int32_t)) > size) {
+      return false;
+    }
+    memcpy(&tuple_size, data + pos, sizeof(int32_t));
+    if (tuple_size < 0 ||
+        tuple_size > size - pos - static_cast<int32_t>(sizeof(int32_t))) {
+      return false;
+    }
+    tuple.DeserializeFrom(data + pos);
+    pos += sizeof(int32_t) + tuple_size;
+    return true;
+  };
+  switch (log_record.log_record_type_) {
+  case LogRecordType::INSERT:
+    if (pos + static_cast<int32_t>(sizeof(RID)) > size) {
+      return false;
+    }
+    memcpy(&log_record.insert_rid_, data + pos, sizeof(RID));
+    pos += sizeof(RID);
+    if (!read_tuple(log_record.insert_tuple_)) {
+      return false;
+    }
+    break;
+  case LogRecordType::MARKDELETE:
+  case LogRecordType::APPLYDELETE:
+  case LogRecordType::ROLLBACKDELETE:
+    if (pos + static_cast<int32_t>(sizeof(RID)) > size) {
+      return false;
+    }
+    memcpy(&log_record.delete_rid_, data + pos, sizeof(RID));
+    pos += sizeof(RID);
+    if (!read_tuple(log_record.delete_tuple_)) {
+      return false;
+    }
+    break;
+  case LogRecordType::UPDATE:
+    if (pos + static_cast<int32_t>(sizeof(RID)) > size) {
+      return false;
+    }
+    memcpy(&log_record.update_rid_, data + pos, sizeof(RID));
+    pos += sizeof(RID);
+    if (!read_tuple(log_record.old_tuple_) ||
+        !read_tuple(log_record.new_tuple_)) {
+      return false;
+    }
+    break;
+  case LogRecordType::DELTA_UPDATE:
+    if (pos + static_cast<int32_t>(sizeof(RID)) > size) {
+      return false;
+    }
+    memcpy(&log_record.update_rid_, data + pos, sizeof(RID));
+    pos += sizeof(RID);
+    if (!log_record.update_delta_.DeserializeFrom(data + pos, size - pos)) {
+      return false;
+    }
+    pos = size;
+    break;
+  case LogRecordType::NEWPAGE:
+    if (pos + 2 * static_cast<int32_t>(sizeof(page_id_t)) > size) {
+      return false;
+    }
+    memcpy(&log_record.prev_page_id_, data + pos, sizeof(page_id_t));
+    pos += sizeof(page_id_t);
+    memcpy(&log_record.page_id_, data + pos, sizeof(page_id_t));
+    pos += sizeof(page_id_t);
+    break;
+  case LogRecordType::END_CHECKPOINT:
+    for (int table = 0; table < 2; ++table) {
+      int32_t count;
+      if (pos + static_cast<int32_t>(sizeof(int32_t)) > size) {
+        return false;
+      }
+      memcpy(&count, data + pos, sizeof(int32_t));
+      pos += sizeof(int32_t);
+      if (count < 0 || count > (size - pos) / 8) {
+        return false;
+      }
+      for (int i = 0; i < count; ++i, pos += 8) {
+        int32_t id;
+        lsn_t lsn;
+        memcpy(&id, data + pos, sizeof(int32_t));
+        memcpy(&lsn, data + pos + 4, sizeof(lsn_t));
+        if (table == 0) {
+          log_record.active_txns_.emplace_back(id, lsn);
+        } else {
+          log_record.dirty_pages_.emplace_back(id, lsn);
+        }
+      }
+    }
+    break;
+  default:
+    // BEGIN/COMMIT/ABORT/BEGIN_CHECKPOINT have no body
+    break;
+  }
+  return pos == size;
 }
 
 /*
@@ -22,13 +152,423 @@ bool LogRecovery::DeserializeLogRecord(const char *data,
  *log buffer to reduce unnecessary I/O operations), remember to compare page's
  *LSN with log_record's sequence number, and also build active_txn_ table &
  *lsn_mapping_ table
+ * The log is read LOG_RECOVERY_READ_SIZE bytes at a time; a record cut off
+ * at the end of the buffer is read again with the next chunk. The records
+ * of a page go to the redo thread of that page in batches, a NEWPAGE record
+ * also to the thread of the previous page, which gets linked to the new one.
+ * The log ends at the first record that is incomplete or does not carry the
+ * next LSN, i.e. at a torn write.
+ * With a checkpoint, reading starts at the offset of its master record; the
+ * transactions not committed by then began after that offset, so undo
+ * finds all their records.
+ */
+bool LogRecovery::Redo() {
+  assert(!ENABLE_LOGGING);
+  redo_failed_ = false;
+  active_txn_.clear();
+  lsn_mapping_.clear();
+  queues_.clear();
+  std::vector<std::thread> workers;
+  for (int i = 0; i < num_workers_; ++i) {
+    queues_.emplace_back(new RedoQueue);
+  }
+  for (int i = 0; i < num_workers_; ++i) {
+    workers.emplace_back(&LogRecovery::RedoWorker, this, i);
+  }
+
+  std::vector<RedoBatch> pending(num_workers_);
+  lsn_t next_lsn = INVALID_LSN;
+  bool end = false;
+  offset_ = 0;
+  MasterRecord master;
+  if (CheckpointManager::ReadMasterRecord(buffer_pool_manager_, master) &&
+      ReadCheckpoint(master)) {
+    offset_ = master.redo_offset;
+  }
+  while (!end &&
+         disk_manager_->ReadLog(log_buffer_, LOG_RECOVERY_READ_SIZE, offset_)) {
+    int pos = 0;
+    while (true) {
+      std::unique_ptr<LogRecord> log_record(new LogRecord);
+      if (!DeserializeLogRecord(log_buffer_ + pos, *log_record)) {
+        break;
+      }
+      if (next_lsn != INVALID_LSN && log_record->lsn_ != next_lsn) {
+        end = true;
+        break;
+      }
+      next_lsn = log_record->lsn_ + 1;
+      lsn_mapping_[log_record->lsn_] = offset_ + pos;
+      pos += log_record->size_;
+
+      txn_id_t txn_id = log_record->txn_id_;
+      page_id_t page_id;
+      switch (log_record->log_record_type_) {
+      case LogRecordType::COMMIT:
+      case LogRecordType::ABORT:
+        active_txn_.erase(txn_id);
+        continue;
+      case LogRecordType::BEGIN:
+        active_txn_[txn_id] = log_record->lsn_;
+        continue;
+      case LogRecordType::BEGIN_CHECKPOINT:
+      case LogRecordType::END_CHECKPOINT:
+        continue;
+      case LogRecordType::INSERT:
+        page_id = log_record->insert_rid_.GetPageId();
+        break;
+      case LogRecordType::UPDATE:
+      case LogRecordType::DELTA_UPDATE:
+        page_id = log_record->update_rid_.GetPageId();
+        break;
+      case LogRecordType::NEWPAGE:
+        page_id = log_record->page_id_;
+        if (log_record->prev_page_id_ != INVALID_PAGE_ID &&
+            WorkerOf(log_record->prev_page_id_) != WorkerOf(page_id)) {
+          pending[WorkerOf(log_record->prev_page_id_)].emplace_back(
+              new LogRecord(*log_record));
+        }
+        break;
+      default:
+        page_id = log_record->delete_rid_.GetPageId();
+        break;
+      }
+      active_txn_[txn_id] = log_record->lsn_;
+      if (!NeedsRedo(*log_record, page_id)) {
+        continue;
+      }
+      pending[WorkerOf(page_id)].push_back(std::move(log_record));
+      Dispatch(pending, false);
+    }
+    // no complete record in a whole buffer: the log ends here
+    if (pos == 0) {
+      break;
+    }
+    offset_ += pos;
+  }
+  Dispatch(pending, true);
+  if (next_lsn != INVALID_LSN) {
+    next_lsn_ = next_lsn;
+  }
+
+  for (auto &queue : queues_) {
+    std::lock_guard<std::mutex> guard(queue->latch);
+    queue->done = true;
+    queue->cv.notify_all();
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  queues_.clear();
+  return !redo_failed_;
+}
+
+/*
+ * Find the END_CHECKPOINT record of master and load its tables. It was
+ * written by a single flush, which starts at the checkpoint offset and is
+ * no larger than a log buffer. false if the log does not have it.
+ */
+bool LogRecovery::ReadCheckpoint(const MasterRecord &master) {
+  checkpoint_lsn_ = INVALID_LSN;
+  checkpoint_txns_.clear();
+  checkpoint_pages_.clear();
+  if (!disk_manager_->ReadLog(log_buffer_, LOG_RECOVERY_READ_SIZE,
+                              master.checkpoint_offset)) {
+    return false;
+  }
+  LogRecord log_record;
+  for (int pos = 0; pos < LOG_BUFFER_SIZE; pos += log_record.size_) {
+    log_record = LogRecord();
+    if (!DeserializeLogRecord(log_buffer_ + pos, log_record)) {
+      return false;
+    }
+    if (log_record.lsn_ == master.checkpoint_lsn) {
+      break;
+    }
+  }
+  if (log_record.lsn_ != master.checkpoint_lsn ||
+      log_record.log_record_type_ != LogRecordType::END_CHECKPOINT) {
+    return false;
+  }
+  checkpoint_lsn_ = log_record.prev_lsn_;
+  for (auto &txn : log_record.active_txns_) {
+    checkpoint_txns_.insert(txn.first);
+  }
+  for (auto &page : log_record.dirty_pages_) {
+    auto iter = checkpoint_pages_.find(page.first);
+    if (iter == checkpoint_pages_.end() || page.second < iter->second) {
+      checkpoint_pages_[page.first] = page.second;
+    }
+  }
+  return true;
+}
+
+/*
+ * A change logged before the checkpoint is on disk unless its page was in
+ * the dirty page table, from its recLSN on, or its transaction was still
+ * running. The link of the previous page of a NEWPAGE record has no recLSN,
+ * so NEWPAGE records are always replayed.
  */
-void LogRecovery::Redo() {}
+bool LogRecovery::NeedsRedo(const LogRecord &log_record,
+                            page_id_t page_id) const {
+  if (checkpoint_lsn_ == INVALID_LSN || log_record.lsn_ >= checkpoint_lsn_ ||
+      log_record.log_record_type_ == LogRecordType::NEWPAGE ||
+      checkpoint_txns_.count(log_record.txn_id_) > 0) {
+    return true;
+  }
+  auto iter = checkpoint_pages_.find(page_id);
+  return iter != checkpoint_pages_.end() && iter->second <= log_record.lsn_;
+}
+
+/*
+ * Hand the batches that are full, or all of them (force), to their redo
+ * threads. Waits while a thread is far behind, so the log is not read into
+ * memory as a whole.
+ */
+void LogRecovery::Dispatch(std::vector<RedoBatch> &pending, bool force) {
+  for (int i = 0; i < num_workers_; ++i) {
+    if (pending[i].empty() ||
+        (!force && pending[i].size() < REDO_BATCH_SIZE)) {
+      continue;
+    }
+    RedoQueue &queue = *queues_[i];
+    std::unique_lock<std::mutex> lock(queue.latch);
+    while (queue.batches.size() >= REDO_MAX_BATCHES) {
+      queue.cv.wait(lock);
+    }
+    queue.batches.push_back(std::move(pending[i]));
+    queue.cv.notify_all();
+    pending[i].clear();
+  }
+}
+
+void LogRecovery::RedoWorker(int worker) {
+  RedoQueue &queue = *queues_[worker];
+  while (true) {
+    RedoBatch batch;
+    {
+      std::unique_lock<std::mutex> lock(queue.latch);
+      while (queue.batches.empty() && !queue.done) {
+        queue.cv.wait(lock);
+      }
+      if (queue.batches.empty()) {
+        return;
+      }
+      batch = std::move(queue.batches.front());
+      queue.batches.pop_front();
+      queue.cv.notify_all();
+    }
+    for (auto &log_record : batch) {
+      if (!RedoRecord(worker, *log_record)) {
+        redo_failed_ = true;
+      }
+    }
+  }
+}
+
+/*
+ * Replay a record on its page unless the page already has it, i.e. its LSN
+ * is not older. Linking the previous page of a NEWPAGE record is not a
+ * logged change of that page, so its LSN stays.
+ * return false if the page can not be fetched or the change does not apply
+ */
+bool LogRecovery::RedoRecord(int worker, LogRecord &log_record) {
+  if (log_record.log_record_type_ == LogRecordType::NEWPAGE) {
+    page_id_t page_id = log_record.page_id_;
+    page_id_t prev_page_id = log_record.prev_page_id_;
+    bool fetched = true;
+    if (WorkerOf(page_id) == worker) {
+      WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(page_id);
+      auto page = static_cast<TablePage *>(guard.GetPage());
+      fetched = fetched && guard;
+      if (guard && page->GetLSN() < log_record.lsn_) {
+        page->Init(page_id, page->GetPageSize(), prev_page_id, nullptr,
+                   nullptr);
+        page->SetLSN(log_record.lsn_);
+        guard.MarkDirty();
+      }
+    }
+    if (prev_page_id != INVALID_PAGE_ID && WorkerOf(prev_page_id) == worker) {
+      WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(prev_page_id);
+      auto page = static_cast<TablePage *>(guard.GetPage());
+      fetched = fetched && guard;
+      if (guard && page->GetLSN() < log_record.lsn_) {
+        page->SetNextPageId(page_id);
+        guard.MarkDirty();
+      }
+    }
+    if (!fetched) {
+      LOG_DEBUG("redo: can not fetch the pages of lsn %d", log_record.lsn_);
+    }
+    return fetched;
+  }
+
+  RID rid = log_record.log_record_type_ == LogRecordType::INSERT
+                ? log_record.insert_rid_
+                : log_record.log_record_type_ == LogRecordType::UPDATE ||
+                          log_record.log_record_type_ ==
+                              LogRecordType::DELTA_UPDATE
+                      ? log_record.update_rid_
+                      : log_record.delete_rid_;
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  if (!guard) {
+    LOG_DEBUG("redo: can not fetch page %d", rid.GetPageId());
+    return false;
+  }
+  auto page = static_cast<TablePage *>(guard.GetPage());
+  if (page->GetLSN() >= log_record.lsn_) {
+    return true;
+  }
+  switch (log_record.log_record_type_) {
+  case LogRecordType::INSERT:
+    if (!page->InsertTupleAt(log_record.insert_tuple_, rid)) {
+      LOG_DEBUG("redo: slot of lsn %d is taken", log_record.lsn_);
+      return false;
+    }
+    break;
+  case LogRecordType::MARKDELETE:
+    page->MarkDelete(rid, nullptr, nullptr, nullptr);
+    break;
+  case LogRecordType::APPLYDELETE:
+    page->ApplyDelete(rid, nullptr, nullptr);
+    break;
+  case LogRecordType::ROLLBACKDELETE:
+    page->RollbackDelete(rid, nullptr, nullptr);
+    break;
+  case LogRecordType::UPDATE: {
+    Tuple old_tuple;
+    page->UpdateTuple(log_record.new_tuple_, old_tuple, rid, nullptr, nullptr,
+                      nullptr);
+    break;
+  }
+  case LogRecordType::DELTA_UPDATE: {
+    Tuple old_tuple, new_tuple;
+    if (!page->GetTuple(rid, old_tuple, nullptr, nullptr) ||
+        !log_record.update_delta_.Redo(old_tuple, new_tuple)) {
+      LOG_DEBUG("redo: delta of lsn %d does not fit", log_record.lsn_);
+      return false;
+    }
+    page->UpdateTuple(new_tuple, old_tuple, rid, nullptr, nullptr, nullptr);
+    break;
+  }
+  default:
+    break;
+  }
+  page->SetLSN(log_record.lsn_);
+  guard.MarkDirty();
+  return true;
+}
 
 /*
  *undo phase on TABLE PAGE level(table/table_page.h)
  *iterate through active txn map and undo each operation
+ * The changes of all the active transactions are undone newest first,
+ * following the prev LSN chain of each; the records are read back from
+ * the log through lsn_mapping_.
  */
-void LogRecovery::Undo() {}
+bool LogRecovery::Undo() {
+  assert(!ENABLE_LOGGING);
+  bool undone = true;
+  std::priority_queue<lsn_t> undo_lsns;
+  for (auto &txn : active_txn_) {
+    undo_lsns.push(txn.second);
+  }
+  while (!undo_lsns.empty()) {
+    lsn_t lsn = undo_lsns.top();
+    undo_lsns.pop();
+    auto iter = lsn_mapping_.find(lsn);
+    if (iter == lsn_mapping_.end()) {
+      LOG_DEBUG("undo: lsn %d is not in the log", lsn);
+      undone = false;
+      continue;
+    }
+    offset_ = iter->second;
+    LogRecord log_record;
+    disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, offset_);
+    if (!DeserializeLogRecord(log_buffer_, log_record)) {
+      LOG_DEBUG("undo: can not read lsn %d", lsn);
+      undone = false;
+      continue;
+    }
+    if (!UndoRecord(log_record)) {
+      undone = false;
+    }
+    if (log_record.prev_lsn_ != INVALID_LSN) {
+      undo_lsns.push(log_record.prev_lsn_);
+    }
+  }
+  active_txn_.clear();
+  lsn_mapping_.clear();
+  return undone;
+}
+
+/*
+ * The inverse of a change, as TransactionManager::Abort() does it; a tuple
+ * whose delete is undone goes back into its slot
+ * return false if the page can not be fetched or the change does not apply
+ */
+bool LogRecovery::UndoRecord(LogRecord &log_record) {
+  RID rid;
+  switch (log_record.log_record_type_) {
+  case LogRecordType::INSERT:
+    rid = log_record.insert_rid_;
+    break;
+  case LogRecordType::UPDATE:
+  case LogRecordType::DELTA_UPDATE:
+    rid = log_record.update_rid_;
+    break;
+  case LogRecordType::MARKDELETE:
+  case LogRecordType::APPLYDELETE:
+  case LogRecordType::ROLLBACKDELETE:
+    rid = log_record.delete_rid_;
+    break;
+  default:
+    // a new page stays, it is linked into the table already
+    return true;
+  }
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  if (!guard) {
+    LOG_DEBUG("undo: can not fetch page %d", rid.GetPageId());
+    return false;
+  }
+  auto page = static_cast<TablePage *>(guard.GetPage());
+  switch (log_record.log_record_type_) {
+  case LogRecordType::INSERT:
+    page->ApplyDelete(rid, nullptr, nullptr);
+    break;
+  case LogRecordType::MARKDELETE:
+    page->RollbackDelete(rid, nullptr, nullptr);
+    break;
+  case LogRecordType::APPLYDELETE:
+    if (!page->InsertTupleAt(log_record.delete_tuple_, rid)) {
+      LOG_DEBUG("undo: slot of lsn %d is taken", log_record.lsn_);
+      return false;
+    }
+    break;
+  case LogRecordType::ROLLBACKDELETE:
+    page->MarkDelete(rid, nullptr, nullptr, nullptr);
+    break;
+  case LogRecordType::UPDATE: {
+    Tuple new_tuple;
+    page->UpdateTuple(log_record.old_tuple_, new_tuple, rid, nullptr, nullptr,
+                      nullptr);
+    break;
+  }
+  case LogRecordType::DELTA_UPDATE: {
+    Tuple new_tuple, old_tuple;
+    if (!page->GetTuple(rid, new_tuple, nullptr, nullptr) ||
+        !log_record.update_delta_.Undo(new_tuple, old_tuple)) {
+      LOG_DEBUG("undo: delta of lsn %d does not fit", log_record.lsn_);
+      return false;
+    }
+    page->UpdateTuple(old_tuple, new_tuple, rid, nullptr, nullptr, nullptr);
+    break;
+  }
+  default:
+    break;
+  }
+  guard.MarkDirty();
+  return true;
+}
 
 } // namespace scudb
@@ -0,0 +1,131 @@
+/**
+ * tuple_delta.cpp
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "logging/tuple_delta.h"
+
+namespace scudb {
+// bytes of the offset and length of a range
+static const int32_t RANGE_HEADER_SIZE = 2 * sizeof(uint16_t);
+static const int32_t MAX_RANGE_LENGTH = 0xffff;
+
+/*
+ * Tuples are smaller than a page, which is 64KB at most, so offsets and
+ * lengths fit into 16 bits; a longer range would be split anyway
+ */
+TupleDelta::TupleDelta(const Tuple &old_tuple, const Tuple &new_tuple)
+    : old_size_(old_tuple.GetLength()), new_size_(new_tuple.GetLength()),
+      range_count_(0) {
+  int32_t size = std::max(old_size_, new_size_);
+  auto diff = [&](int32_t i) -> char {
+    char old_byte = i < old_size_ ? old_tuple.GetData()[i] : 0;
+    char new_byte = i < new_size_ ? new_tuple.GetData()[i] : 0;
+    return old_byte ^ new_byte;
+  };
+  int32_t i = 0;
+  while (i < size) {
+    if (diff(i) == 0) {
+      ++i;
+      continue;
+    }
+    // equal bytes in between cost less than another range
+    int32_t end = i + 1;
+    for (int32_t j = end; j < size && j - end < RANGE_HEADER_SIZE &&
+                          j < i + MAX_RANGE_LENGTH;
+         ++j) {
+      if (diff(j) != 0) {
+        end = j + 1;
+      }
+    }
+    uint16_t header[2] = {static_cast<uint16_t>(i),
+                          static_cast<uint16_t>(end - i)};
+    const char *header_data = reinterpret_cast<const char *>(header);
+    ranges_.insert(ranges_.end(), header_data, header_data + RANGE_HEADER_SIZE);
+    for (; i < end; ++i) {
+      ranges_.push_back(diff(i));
+    }
+    range_count_++;
+  }
+}
+
+void TupleDelta::SerializeTo(char *storage) const {
+  memcpy(storage, &old_size_, sizeof(int32_t));
+  memcpy(storage + 4, &new_size_, sizeof(int32_t));
+  memcpy(storage + 8, &range_count_, sizeof(int32_t));
+  if (!ranges_.empty()) {
+    memcpy(storage + 12, ranges_.data(), ranges_.size());
+  }
+}
+
+bool TupleDelta::DeserializeFrom(const char *storage, int32_t size) {
+  if (size < 3 * static_cast<int32_t>(sizeof(int32_t))) {
+    return false;
+  }
+  memcpy(&old_size_, storage, sizeof(int32_t));
+  memcpy(&new_size_, storage + 4, sizeof(int32_t));
+  memcpy(&range_count_, storage + 8, sizeof(int32_t));
+  if (old_size_ < 0 || new_size_ < 0 || range_count_ < 0) {
+    return false;
+  }
+  // the ranges must lie within the images and end where the delta does
+  int32_t pos = 12;
+  for (int32_t i = 0; i < range_count_; ++i) {
+    uint16_t header[2];
+    if (pos + RANGE_HEADER_SIZE > size) {
+      return false;
+    }
+    memcpy(header, storage + pos, RANGE_HEADER_SIZE);
+    pos += RANGE_HEADER_SIZE + header[1];
+    if (pos > size || header[0] + header[1] > std::max(old_size_, new_size_)) {
+      return false;
+    }
+  }
+  if (pos != size) {
+    return false;
+  }
+  ranges_.assign(storage + 12, storage + size);
+  return true;
+}
+
+bool TupleDelta::Redo(const Tuple &old_tuple, Tuple &new_tuple) const {
+  return Apply(old_tuple, old_size_, new_size_, new_tuple);
+}
+
+bool TupleDelta::Undo(const Tuple &new_tuple, Tuple &old_tuple) const {
+  return Apply(new_tuple, new_size_, old_size_, old_tuple);
+}
+
+/*
+ * The result is built in the serialized form of a tuple, see
+ * Tuple::SerializeTo()
+ */
+bool TupleDelta::Apply(const Tuple &from, int32_t from_size, int32_t to_size,
+                       Tuple &to) const {
+  if (from.GetLength() != from_size) {
+    return false;
+  }
+  std::vector<char> storage(sizeof(int32_t) + std::max(old_size_, new_size_),
+                            0);
+  char *image = storage.data() + sizeof(int32_t);
+  memcpy(storage.data(), &to_size, sizeof(int32_t));
+  if (from_size > 0) {
+    memcpy(image, from.GetData(), from_size);
+  }
+  size_t pos = 0;
+  for (int32_t i = 0; i < range_count_; ++i) {
+    uint16_t header[2];
+    memcpy(header, ranges_.data() + pos, RANGE_HEADER_SIZE);
+    pos += RANGE_HEADER_SIZE;
+    for (int32_t j = 0; j < header[1]; ++j) {
+      image[header[0] + j] ^= ranges_[pos + j];
+    }
+    pos += header[1];
+  }
+  to.DeserializeFrom(storage.data());
+  return true;
+}
+
+} // namespace scudb
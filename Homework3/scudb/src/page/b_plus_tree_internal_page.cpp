@@ -18,12 +18,13 @@ namespace scudb {
  */
     INDEX_TEMPLATE_ARGUMENTS
     void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id,
-                                              page_id_t parent_id) {
+                                              page_id_t parent_id,
+                                              int page_size) {
         SetPageType(IndexPageType::INTERNAL_PAGE);
         SetSize(0);
         SetPageId(page_id);
         SetParentPageId(parent_id);
-        SetMaxSize((PAGE_SIZE- sizeof(BPlusTreeInternalPage))/sizeof(MappingType) - 1); //minus 1 for first invalid key
+        SetMaxSize((page_size - sizeof(BPlusTreeInternalPage))/sizeof(MappingType) - 1); //minus 1 for first invalid key
     }
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
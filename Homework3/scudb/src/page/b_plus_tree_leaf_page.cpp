@@ -21,11 +21,11 @@ namespace scudb {
  * next page id and set max size
  */
     INDEX_TEMPLATE_ARGUMENTS
-    void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id) {
+    void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int page_size) {
         SetPageType(IndexPageType::LEAF_PAGE);
         SetSize(0);
         assert(sizeof(BPlusTreeLeafPage) == 28);
-        SetMaxSize((PAGE_SIZE - sizeof(BPlusTreeLeafPage))/sizeof(MappingType) - 1);
+        SetMaxSize((page_size - sizeof(BPlusTreeLeafPage))/sizeof(MappingType) - 1);
         SetPageId(page_id);
         SetParentPageId(parent_id);
         SetNextPageId(INVALID_PAGE_ID);
@@ -74,7 +74,7 @@ INDEX_TEMPLATE_ARGUMENTS
  * "index"(a.k.a array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
+const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const {
     assert(index >= 0 && index < GetSize());
     return array[index];
 }
@@ -8,6 +8,36 @@
 
 namespace scudb {
 
+bool HeaderPage::IsInitialized() {
+  int page_size;
+  memcpy(&page_size, GetData() + PAGE_SIZE_OFFSET, 4);
+  int record_num = GetRecordCount();
+  return page_size == GetPageSize() && record_num >= 0 &&
+         RECORDS_OFFSET + record_num * 36 <= GetPageSize();
+}
+
+/**
+ * Master record related
+ */
+void HeaderPage::SetMasterRecord(lsn_t checkpoint_lsn,
+                                 int64_t checkpoint_offset,
+                                 int64_t redo_offset) {
+  char *data = GetData() + MASTER_RECORD_OFFSET;
+  memcpy(data, &checkpoint_lsn, 4);
+  memcpy(data + 4, &checkpoint_offset, 8);
+  memcpy(data + 12, &redo_offset, 8);
+}
+
+bool HeaderPage::GetMasterRecord(lsn_t &checkpoint_lsn,
+                                 int64_t &checkpoint_offset,
+                                 int64_t &redo_offset) {
+  const char *data = GetData() + MASTER_RECORD_OFFSET;
+  memcpy(&checkpoint_lsn, data, 4);
+  memcpy(&checkpoint_offset, data + 4, 8);
+  memcpy(&redo_offset, data + 12, 8);
+  return checkpoint_lsn != INVALID_LSN;
+}
+
 /**
  * Record related
  */
@@ -17,10 +47,13 @@ bool HeaderPage::InsertRecord(const std::string &name,
   assert(root_id > INVALID_PAGE_ID);
 
   int record_num = GetRecordCount();
-  int offset = 4 + record_num * 36;
+  int offset = RECORDS_OFFSET + record_num * 36;
   // check for duplicate name
   if (FindRecord(name) != -1)
     return false;
+  // header page is full
+  if (offset + 36 > GetPageSize())
+    return false;
   // copy record content
   memcpy(GetData() + offset, name.c_str(), (name.length() + 1));
   memcpy((GetData() + offset + 32), &root_id, 4);
@@ -37,7 +70,7 @@ bool HeaderPage::DeleteRecord(const std::string &name) {
   // record does not exsit
   if (index == -1)
     return false;
-  int offset = index * 36 + 4;
+  int offset = index * 36 + RECORDS_OFFSET;
   memmove(GetData() + offset, GetData() + offset + 36,
           (record_num - index - 1) * 36);
 
@@ -53,7 +86,7 @@ bool HeaderPage::UpdateRecord(const std::string &name,
   // record does not exsit
   if (index == -1)
     return false;
-  int offset = index * 36 + 4;
+  int offset = index * 36 + RECORDS_OFFSET;
   // update record content, only root_id
   memcpy((GetData() + offset + 32), &root_id, 4);
 
@@ -67,7 +100,7 @@ bool HeaderPage::GetRootId(const std::string &name, page_id_t &root_id) {
   // record does not exsit
   if (index == -1)
     return false;
-  int offset = (index + 1) * 36;
+  int offset = index * 36 + RECORDS_OFFSET + 32;
   root_id = *reinterpret_cast<page_id_t *>(GetData() + offset);
 
   return true;
@@ -87,7 +120,7 @@ int HeaderPage::FindRecord(const std::string &name) {
   int record_num = GetRecordCount();
 
   for (int i = 0; i < record_num; i++) {
-    char *raw_name = reinterpret_cast<char *>(GetData() + (4 + i * 36));
+    char *raw_name = reinterpret_cast<char *>(GetData() + (RECORDS_OFFSET + i * 36));
     if (strcmp(raw_name, name.c_str()) == 0)
       return i;
   }
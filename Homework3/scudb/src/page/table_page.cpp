@@ -15,7 +15,11 @@ void TablePage::Init(page_id_t page_id, size_t page_size,
                      Transaction *txn) {
   memcpy(GetData(), &page_id, 4); // set page_id
   if (ENABLE_LOGGING) {
-    // TODO: add your logging logic here
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
+                         LogRecordType::NEWPAGE, prev_page_id, page_id);
+    lsn_t lsn = log_manager->AppendLogRecord(log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
   }
   SetPrevPageId(prev_page_id);
   SetNextPageId(INVALID_PAGE_ID);
@@ -87,12 +91,44 @@ bool TablePage::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn,
   if (ENABLE_LOGGING) {
     // acquire the exclusive lock
     assert(lock_manager->LockExclusive(txn, rid.Get()));
-    // TODO: add your logging logic here
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
+                         LogRecordType::INSERT, rid, tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
   }
   // LOG_DEBUG("Tuple inserted");
   return true;
 }
 
+/*
+ * Recovery puts a tuple back where the log says it was: into the slot of rid,
+ * which must be empty, or be the first slot after the existing ones. return
+ * false if the slot is taken or the page has no room for the tuple
+ */
+bool TablePage::InsertTupleAt(const Tuple &tuple, const RID &rid) {
+  assert(tuple.size_ > 0);
+  int slot_num = rid.GetSlotNum();
+  if (slot_num > GetTupleCount() ||
+      (slot_num < GetTupleCount() && GetTupleSize(slot_num) != 0)) {
+    return false;
+  }
+  // a new slot takes 8 bytes of the free space as well
+  int32_t needed = tuple.size_ + (slot_num == GetTupleCount() ? 8 : 0);
+  if (GetFreeSpaceSize() < needed) {
+    return false;
+  }
+
+  SetFreeSpacePointer(GetFreeSpacePointer() - tuple.size_);
+  memcpy(GetData() + GetFreeSpacePointer(), tuple.data_, tuple.size_);
+  SetTupleOffset(slot_num, GetFreeSpacePointer());
+  SetTupleSize(slot_num, tuple.size_);
+  if (slot_num == GetTupleCount()) {
+    SetTupleCount(GetTupleCount() + 1);
+  }
+  return true;
+}
+
 /*
  * MarkDelete method does not truly delete a tuple from table page
  * Instead it set the tuple as 'deleted' by changing the tuple size metadata to
@@ -128,7 +164,12 @@ bool TablePage::MarkDelete(const RID &rid, Transaction *txn,
                !lock_manager->LockExclusive(txn, rid)) { // no shared lock
       return false;
     }
-    // TODO: add your logging logic here
+    // the tuple stays on the page, only the rid is needed
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
+                         LogRecordType::MARKDELETE, rid, Tuple());
+    lsn_t lsn = log_manager->AppendLogRecord(log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
   }
 
   // set tuple size to negative value
@@ -182,7 +223,11 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple &old_tuple,
                !lock_manager->LockExclusive(txn, rid)) { // no shared lock
       return false;
     }
-    // TODO: add your logging logic here
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
+                         LogRecordType::UPDATE, rid, old_tuple, new_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
   }
 
   // update
@@ -234,7 +279,11 @@ void TablePage::ApplyDelete(const RID &rid, Transaction *txn,
     // must already grab the exclusive lock
     assert(txn->GetExclusiveLockSet()->find(rid) !=
            txn->GetExclusiveLockSet()->end());
-    // TODO: add your logging logic here
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
+                         LogRecordType::APPLYDELETE, rid, delete_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
   }
 
   int32_t free_space_pointer =
@@ -266,7 +315,11 @@ void TablePage::RollbackDelete(const RID &rid, Transaction *txn,
     assert(txn->GetExclusiveLockSet()->find(rid) !=
            txn->GetExclusiveLockSet()->end());
 
-    // TODO: add your logging logic here
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(),
+                         LogRecordType::ROLLBACKDELETE, rid, Tuple());
+    lsn_t lsn = log_manager->AppendLogRecord(log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
   }
 
   int slot_num = rid.GetSlotNum();
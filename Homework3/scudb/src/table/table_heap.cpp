@@ -3,7 +3,9 @@
  */
 
 #include <cassert>
+#include <utility>
 
+#include "common/exception.h"
 #include "common/logger.h"
 #include "table/table_heap.h"
 
@@ -28,130 +30,129 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager,
   first_page->WLatch();
   LOG_DEBUG("new table page created %d", first_page_id_);
 
-  first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
+  first_page->Init(first_page_id_, first_page->GetPageSize(), INVALID_LSN,
+                   log_manager_, txn);
   first_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
 }
 
 bool TableHeap::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn) {
-  if (tuple.size_ + 32 > PAGE_SIZE) { // larger than one page size
+  // larger than one page size
+  if (tuple.size_ + 32 > buffer_pool_manager_->GetPageSize()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  auto cur_page =
-      static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr) {
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(first_page_id_);
+  if (!guard) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  cur_page->WLatch();
+  auto cur_page = static_cast<TablePage *>(guard.GetPage());
   while (!cur_page->InsertTuple(
       tuple, rid, txn, lock_manager_,
       log_manager_)) { // fail to insert due to not enough space
     auto next_page_id = cur_page->GetNextPageId();
     if (next_page_id != INVALID_PAGE_ID) { // valid next page
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), false);
-      cur_page = static_cast<TablePage *>(
-          buffer_pool_manager_->FetchPage(next_page_id));
-      cur_page->WLatch();
+      guard.Drop();
+      guard = buffer_pool_manager_->FetchPageWrite(next_page_id);
+      if (!guard) {
+        txn->SetState(TransactionState::ABORTED);
+        return false;
+      }
+      cur_page = static_cast<TablePage *>(guard.GetPage());
     } else { // create new page
-      auto new_page =
-          static_cast<TablePage *>(buffer_pool_manager_->NewPage(next_page_id));
-      if (new_page == nullptr) {
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), false);
+      WritePageGuard new_guard(buffer_pool_manager_,
+                               buffer_pool_manager_->NewPage(next_page_id));
+      if (!new_guard) {
         txn->SetState(TransactionState::ABORTED);
         return false;
       }
-      new_page->WLatch();
+      auto new_page = static_cast<TablePage *>(new_guard.GetPage());
       // std::cout << "new table page " << next_page_id << " created" <<
       // std::endl;
       cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetPageId(),
-                     log_manager_, txn);
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), true);
+      new_page->Init(next_page_id, new_page->GetPageSize(),
+                     cur_page->GetPageId(), log_manager_, txn);
+      guard.MarkDirty();
+      guard = std::move(new_guard);
       cur_page = new_page;
     }
   }
-  cur_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), true);
+  guard.MarkDirty();
+  guard.Drop();
   txn->GetWriteSet()->emplace_back(rid, WType::INSERT, Tuple{}, this);
   return true;
 }
 
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   // todo: remove empty page
-  auto page = reinterpret_cast<TablePage *>(
-      buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  if (page == nullptr) {
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  if (!guard) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
-  page->WLatch();
+  auto page = static_cast<TablePage *>(guard.GetPage());
   page->MarkDelete(rid, txn, lock_manager_, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  guard.MarkDirty();
+  guard.Drop();
   txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
   return true;
 }
 
 bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid,
                             Transaction *txn) {
-  auto page = reinterpret_cast<TablePage *>(
-      buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  if (page == nullptr) {
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  if (!guard) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
   Tuple old_tuple;
-  page->WLatch();
+  auto page = static_cast<TablePage *>(guard.GetPage());
   bool is_updated = page->UpdateTuple(tuple, old_tuple, rid, txn, lock_manager_,
                                       log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), is_updated);
+  if (is_updated) {
+    guard.MarkDirty();
+  }
+  guard.Drop();
   if (is_updated && txn->GetState() != TransactionState::ABORTED)
     txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
   return is_updated;
 }
 
 void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
-  auto page = reinterpret_cast<TablePage *>(
-      buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  assert(page != nullptr);
-  page->WLatch();
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  if (!guard) {
+    throw Exception(EXCEPTION_TYPE_TRANSACTION,
+                    "all page are pinned while applying delete");
+  }
+  auto page = static_cast<TablePage *>(guard.GetPage());
   page->ApplyDelete(rid, txn, log_manager_);
   lock_manager_->Unlock(txn, rid);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  guard.MarkDirty();
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
-  auto page = reinterpret_cast<TablePage *>(
-      buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  assert(page != nullptr);
-  page->WLatch();
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  if (!guard) {
+    throw Exception(EXCEPTION_TYPE_TRANSACTION,
+                    "all page are pinned while rolling back delete");
+  }
+  auto page = static_cast<TablePage *>(guard.GetPage());
   page->RollbackDelete(rid, txn, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  guard.MarkDirty();
 }
 
 // called by tuple iterator
 bool TableHeap::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn) {
-  auto page = static_cast<TablePage *>(
-      buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  if (page == nullptr) {
+  ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(rid.GetPageId());
+  if (!guard) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
-  page->RLatch();
-  bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
-  return res;
+  auto page = static_cast<TablePage *>(guard.GetPage());
+  return page->GetTuple(rid, tuple, txn, lock_manager_);
 }
 
 bool TableHeap::DeleteTableHeap() {
@@ -160,15 +161,17 @@ bool TableHeap::DeleteTableHeap() {
 }
 
 TableIterator TableHeap::begin(Transaction *txn) {
-  auto page =
-      static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  page->RLatch();
   RID rid;
-  // if failed (no tuple), rid will be the result of default
-  // constructor, which means eof
-  page->GetFirstTupleRid(rid);
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(first_page_id_, false);
+  {
+    ReadPageGuard guard =
+        buffer_pool_manager_->FetchPageRead(first_page_id_, scan_strategy_);
+    if (!guard) {
+      throw Exception("all page are pinned while iterating");
+    }
+    // if failed (no tuple), rid will be the result of default
+    // constructor, which means eof
+    static_cast<TablePage *>(guard.GetPage())->GetFirstTupleRid(rid);
+  }
   return TableIterator(this, rid, txn);
 }
 
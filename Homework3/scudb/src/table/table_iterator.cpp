@@ -2,8 +2,11 @@
  * table_iterator.cpp
  */
 
+#include <algorithm>
 #include <cassert>
+#include <vector>
 
+#include "common/exception.h"
 #include "table/table_heap.h"
 
 namespace scudb {
@@ -11,7 +14,21 @@ namespace scudb {
 TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
     : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
-    table_heap_->GetTuple(tuple_->rid_, *tuple_, txn_);
+    // the tuple is read under the scan strategy as well, so that a scan does
+    // not look like repeated use of its pages to the replacer
+    ReadPageGuard guard = table_heap_->buffer_pool_manager_->FetchPageRead(
+        rid.GetPageId(), table_heap_->scan_strategy_);
+    if (!guard) {
+      delete tuple_;
+      throw Exception("all page are pinned while iterating");
+    }
+    auto page = static_cast<TablePage *>(guard.GetPage());
+    page->GetTuple(tuple_->rid_, *tuple_, txn_, table_heap_->lock_manager_);
+    page_id_t next_page_id = page->GetNextPageId();
+    guard.Drop();
+    if (table_heap_->prefetch_window_ > 0) {
+      ReadAhead(0, rid.GetPageId(), next_page_id);
+    }
   }
 };
 
@@ -27,36 +44,95 @@ Tuple *TableIterator::operator->() {
 
 TableIterator &TableIterator::operator++() {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(
-      buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
-  cur_page->RLatch();
-  assert(cur_page != nullptr); // all pages are pinned
+  ReadPageGuard guard =
+      buffer_pool_manager->FetchPageRead(tuple_->rid_.GetPageId(),
+                                         table_heap_->scan_strategy_);
+  if (!guard) {
+    throw Exception("all page are pinned while iterating");
+  }
+  auto cur_page = static_cast<TablePage *>(guard.GetPage());
 
   RID next_tuple_rid;
+  int advanced = 0; // pages moved forward
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  next_tuple_rid)) { // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(
-          buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetPageId(), false);
-      cur_page = next_page;
-      cur_page->RLatch();
+      advanced++;
+      page_id_t next_page_id = cur_page->GetNextPageId();
+      guard.Drop();
+      guard = buffer_pool_manager->FetchPageRead(next_page_id,
+                                                 table_heap_->scan_strategy_);
+      if (!guard) {
+        throw Exception("all page are pinned while iterating");
+      }
+      cur_page = static_cast<TablePage *>(guard.GetPage());
       if (cur_page->GetFirstTupleRid(next_tuple_rid))
         break;
     }
   }
   tuple_->rid_ = next_tuple_rid;
 
+  // the next tuple is on cur_page
   if (*this != table_heap_->end()) {
-    table_heap_->GetTuple(tuple_->rid_, *tuple_, txn_);
+    cur_page->GetTuple(tuple_->rid_, *tuple_, txn_, table_heap_->lock_manager_);
   }
   // release until copy the tuple
-  cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetPageId(), false);
+  page_id_t cur_page_id = cur_page->GetPageId();
+  page_id_t next_page_id = cur_page->GetNextPageId();
+  guard.Drop();
+  if (advanced > 0 && *this != table_heap_->end()) {
+    ReadAhead(advanced, cur_page_id, next_page_id);
+  }
   return *this;
 }
 
+/**
+ * Called after the iterator has moved forward by advanced pages onto page_id.
+ * Keeps the next prefetch_window_ pages of the chain requested from the buffer
+ * pool. The id of a page further ahead is only known from the header of its
+ * predecessor, which was requested earlier and is most likely resident by now.
+ * A bulk read recycles its ring for them, which has to hold the current page
+ * as well, so the window is at most one page smaller than the ring; with the
+ * one frame ring of a tiny pool there is no read ahead at all.
+ */
+void TableIterator::ReadAhead(int advanced, page_id_t page_id,
+                              page_id_t next_page_id) {
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  int window = table_heap_->prefetch_window_;
+  if (table_heap_->scan_strategy_ != AccessStrategy::NORMAL) {
+    window = std::min(
+        window, static_cast<int>(buffer_pool_manager->GetRingSize()) - 1);
+  }
+  read_ahead_ = std::max(read_ahead_ - advanced, 0);
+  if (read_ahead_ == 0) {
+    read_ahead_page_id_ = page_id;
+  }
+
+  std::vector<page_id_t> page_ids;
+  while (read_ahead_ < window && read_ahead_page_id_ != INVALID_PAGE_ID) {
+    page_id_t ahead_next_page_id = next_page_id;
+    if (read_ahead_page_id_ != page_id) {
+      ReadPageGuard guard = buffer_pool_manager->FetchPageRead(
+          read_ahead_page_id_, table_heap_->scan_strategy_);
+      if (!guard) {
+        break;
+      }
+      ahead_next_page_id =
+          static_cast<TablePage *>(guard.GetPage())->GetNextPageId();
+    }
+    // an invalid id marks the end of the chain, nothing more to request
+    read_ahead_page_id_ = ahead_next_page_id;
+    if (ahead_next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    page_ids.push_back(ahead_next_page_id);
+    read_ahead_++;
+  }
+  if (!page_ids.empty()) {
+    buffer_pool_manager->PrefetchPages(page_ids, table_heap_->scan_strategy_);
+  }
+}
+
 TableIterator TableIterator::operator++(int) {
   TableIterator clone(*this);
   ++(*this);
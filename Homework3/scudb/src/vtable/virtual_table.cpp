@@ -365,11 +365,15 @@ __declspec(dllexport)
   // create header page from BufferPoolManager if necessary
   if (!is_file_exist) {
     page_id_t header_page_id;
-    storage_engine_->buffer_pool_manager_->NewPage(header_page_id);
+    HeaderPage *header_page = static_cast<HeaderPage *>(
+        storage_engine_->buffer_pool_manager_->NewPage(header_page_id));
 
     assert(header_page_id == HEADER_PAGE_ID);
+    // records the page size as well
+    header_page->Init();
     storage_engine_->buffer_pool_manager_->UnpinPage(header_page_id, true);
   }
+  storage_engine_->checkpoint_manager_->RunCheckpointThread();
 
   int rc = sqlite3_create_module(db, "vtable", &VtableModule, nullptr);
   return rc;
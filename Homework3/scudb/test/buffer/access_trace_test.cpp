@@ -0,0 +1,113 @@
+/**
+ * access_trace_test.cpp
+ */
+
+#include <cstdio>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/replacer_simulator.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+// replaying the trace of a single threaded workload with the policy and
+// pool size it was recorded with gives the misses the pool had, as long as
+// the pool has no dirty victims to pass over
+TEST(AccessTraceTest, ReplayTest) {
+  const size_t pool_size = 10;
+  auto frame_index = [](const int &frame) { return static_cast<size_t>(frame); };
+  for (ReplacerType type :
+       {ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::LRU_K}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    page_id_t temp_page_id;
+    {
+      BufferPoolManager bpm(pool_size, disk_manager);
+      for (int i = 0; i < 40; ++i) {
+        ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+        EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+      }
+      bpm.FlushAllPages();
+    }
+    // the trace starts with an empty pool, like the simulation
+    BufferPoolManager bpm(pool_size, disk_manager, nullptr, type);
+    EXPECT_EQ(true, bpm.StartTrace("test.trace"));
+    // a skewed workload, with a page deleted now and then
+    std::mt19937 rng(42);
+    std::geometric_distribution<int> skewed(0.1);
+    size_t num_records = 0;
+    for (int i = 0; i < 2000; ++i) {
+      page_id_t page_id = skewed(rng) % 40;
+      if (i % 500 == 499) {
+        EXPECT_EQ(true, bpm.DeletePage(page_id));
+        ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+        EXPECT_EQ(page_id, temp_page_id);
+        EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+        bpm.FlushAllPages();
+        num_records += 3;
+        continue;
+      }
+      ASSERT_NE(nullptr, bpm.FetchPage(page_id));
+      EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+      num_records += 2;
+    }
+    bpm.StopTrace();
+    BufferPoolStats stats = bpm.GetStats();
+    // not recorded any more
+    ASSERT_NE(nullptr, bpm.FetchPage(0));
+    EXPECT_EQ(true, bpm.UnpinPage(0, false));
+
+    std::vector<TraceRecord> trace;
+    size_t recorded_pool_size = 0;
+    ASSERT_EQ(true, AccessTraceRecorder::ReadTrace("test.trace", trace,
+                                                   &recorded_pool_size));
+    EXPECT_EQ(pool_size, recorded_pool_size);
+    ASSERT_EQ(num_records, trace.size());
+    EXPECT_EQ(TraceOp::FETCH, trace[0].op);
+    EXPECT_EQ(TraceOp::UNPIN, trace[1].op);
+    EXPECT_EQ(trace[0].pageId, trace[1].pageId);
+    EXPECT_EQ(TraceOp::DELETE, trace[998].op);
+    EXPECT_EQ(TraceOp::NEW, trace[999].op);
+    for (size_t i = 1; i < trace.size(); ++i) {
+      EXPECT_LE(trace[i - 1].micros, trace[i].micros);
+    }
+
+    Replacer<int> *replacer;
+    if (type == ReplacerType::LRU) {
+      replacer = new LRUReplacer<int>();
+    } else if (type == ReplacerType::CLOCK) {
+      replacer = new ClockReplacer<int>(pool_size, frame_index);
+    } else {
+      replacer = new LRUKReplacer<int>(pool_size, frame_index, LRUK_REPLACER_K);
+    }
+    SimulationResult result = SimulateTrace(trace, pool_size, *replacer);
+    delete replacer;
+    EXPECT_EQ(stats.fetch_hits + stats.fetch_misses, result.fetches);
+    EXPECT_EQ(stats.fetch_misses, result.misses);
+    EXPECT_EQ(0, result.failures);
+
+    // more frames never miss more often for LRU, and with a frame per page
+    // only the first fetch of a page misses
+    auto curve = MissRatioCurve(trace, {5, 10, 20, 40}, [](size_t) {
+      return new LRUReplacer<int>();
+    });
+    for (size_t i = 1; i < curve.size(); ++i) {
+      EXPECT_LE(curve[i].misses, curve[i - 1].misses);
+    }
+    std::set<page_id_t> seen;
+    size_t first_fetches = 0;
+    for (const TraceRecord &record : trace) {
+      first_fetches +=
+          seen.insert(record.pageId).second && record.op == TraceOp::FETCH;
+    }
+    EXPECT_EQ(first_fetches, curve.back().misses);
+
+    delete disk_manager;
+    remove("test.db");
+    remove("test.trace");
+  }
+}
+
+} // namespace scudb
@@ -2,13 +2,32 @@
  * buffer_pool_manager_test.cpp
  */
 
+#include <atomic>
+#include <chrono>
 #include <cstdio>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 
 namespace scudb {
 
+// poll until a background thread of the pool made done() true, false if that
+// takes longer than a loaded machine ever should
+template <typename Done> bool WaitUntil(Done done) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (!done()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  return true;
+}
+
 TEST(BufferPoolManagerTest, SampleTest) {
   page_id_t temp_page_id;
 
@@ -48,4 +67,446 @@ TEST(BufferPoolManagerTest, SampleTest) {
   remove("test.db");
 }
 
+// several threads miss on overlapping pages in a small pool, so frames are
+// constantly written back and read in while other threads hit
+TEST(BufferPoolManagerTest, ConcurrentFetchTest) {
+  const int num_pages = 50;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager);
+
+  page_id_t temp_page_id;
+  for (int i = 0; i < num_pages; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, temp_page_id);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&bpm, t] {
+      std::mt19937 gen(t);
+      char expected[PAGE_SIZE];
+      for (int i = 0; i < 2000; ++i) {
+        page_id_t page_id = gen() % num_pages;
+        Page *page = bpm.FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        snprintf(expected, PAGE_SIZE, "page %d", page_id);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_EQ(true, bpm.UnpinPage(page_id, i % 2 == 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+// with the flush thread writing dirty pages ahead, misses should rarely have
+// to write a dirty victim themselves
+TEST(BufferPoolManagerTest, FlushThreadTest) {
+  const int num_pages = 100;
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager);
+  // let the thread come round often instead of waiting for it
+  auto flush_timeout = BUFFER_POOL_FLUSH_TIMEOUT;
+  BUFFER_POOL_FLUSH_TIMEOUT = std::chrono::milliseconds(1);
+  bpm.RunFlushThread(1.0);
+
+  for (int i = 0; i < num_pages; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    // the flush thread catches up with every page
+    EXPECT_TRUE(WaitUntil([&bpm, i] {
+      return bpm.GetNumBackgroundWrites() + bpm.GetNumForegroundWrites() >
+             static_cast<size_t>(i);
+    }));
+  }
+  bpm.StopFlushThread();
+  BUFFER_POOL_FLUSH_TIMEOUT = flush_timeout;
+
+  EXPECT_LT(0, bpm.GetNumBackgroundWrites());
+  EXPECT_GT(bpm.GetNumBackgroundWrites(), bpm.GetNumForegroundWrites());
+
+  // nothing got lost on the way to disk
+  for (int i = 0; i < num_pages; ++i) {
+    char expected[PAGE_SIZE];
+    Page *page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+// prefetched pages are read in the background and afterwards served from
+// memory
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const int num_pages = 20;
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(10, disk_manager);
+  for (int i = 0; i < num_pages; ++i) {
+    Page *page = bpm->NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(temp_page_id, true));
+  }
+  // pages 0 to 9 have been evicted
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < 5; ++i) {
+    page_ids.push_back(i);
+  }
+  bpm->PrefetchPages(page_ids);
+  // nothing else reads, and a page is read before it is counted
+  EXPECT_TRUE(WaitUntil([bpm, &page_ids] {
+    return bpm->GetStats().disk_read.count == page_ids.size();
+  }));
+
+  // a resident page is returned without reading the disk
+  char garbage[PAGE_SIZE] = "garbage";
+  for (int i = 0; i < 5; ++i) {
+    disk_manager->WritePage(i, garbage);
+  }
+  for (int i = 0; i < 5; ++i) {
+    char expected[PAGE_SIZE];
+    Page *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  // prefetching must not disturb pinned pages or pages being fetched
+  Page *page = bpm->FetchPage(10);
+  ASSERT_NE(nullptr, page);
+  bpm->PrefetchPages({10, 11, 12});
+  EXPECT_EQ(0, strcmp(page->GetData(), "page 10"));
+  EXPECT_EQ(true, bpm->UnpinPage(10, false));
+  EXPECT_EQ(false, bpm->UnpinPage(10, false));
+
+  // the prefetch thread may still be reading
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// guards release the latch and the pin exactly once, also when moved
+TEST(BufferPoolManagerTest, PageGuardTest) {
+  page_id_t page_id;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(2, disk_manager);
+  ASSERT_NE(nullptr, bpm.NewPage(page_id));
+  EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+
+  {
+    WritePageGuard guard = bpm.FetchPageWrite(page_id);
+    ASSERT_TRUE(static_cast<bool>(guard));
+    EXPECT_EQ(page_id, guard.GetPageId());
+    EXPECT_EQ(1, guard.GetPage()->GetPinCount());
+    strcpy(guard.GetData(), "Hello");
+    guard.MarkDirty();
+  }
+  {
+    // two readers share the latch
+    ReadPageGuard guard1 = bpm.FetchPageRead(page_id);
+    ReadPageGuard guard2 = bpm.FetchPageRead(page_id);
+    EXPECT_EQ(2, guard1.GetPage()->GetPinCount());
+    EXPECT_EQ(0, strcmp(guard2.GetData(), "Hello"));
+    ReadPageGuard guard3(std::move(guard1));
+    EXPECT_FALSE(static_cast<bool>(guard1));
+    guard2 = std::move(guard3);
+    EXPECT_EQ(1, guard2.GetPage()->GetPinCount());
+    guard2.Drop();
+    EXPECT_FALSE(static_cast<bool>(guard2));
+  }
+  // both latch and pin are gone: a writer gets in, and the page is evicted
+  // by two other pages after its contents have been written back
+  {
+    WritePageGuard guard = bpm.FetchPageWrite(page_id);
+    EXPECT_EQ(1, guard.GetPage()->GetPinCount());
+  }
+  page_id_t other_page_ids[2];
+  for (page_id_t &other_page_id : other_page_ids) {
+    BasicPageGuard guard(&bpm, bpm.NewPage(other_page_id));
+    ASSERT_TRUE(static_cast<bool>(guard));
+  }
+  ReadPageGuard guard = bpm.FetchPageRead(page_id);
+  EXPECT_EQ(0, strcmp(guard.GetData(), "Hello"));
+  guard.Drop();
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+// every kind of event is counted once, and the I/O shows up in the histograms
+TEST(BufferPoolManagerTest, StatsTest) {
+  page_id_t page_id;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(3, disk_manager);
+
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(page_id));
+  }
+  EXPECT_EQ(nullptr, bpm.NewPage(page_id));
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, true));
+  }
+  ASSERT_NE(nullptr, bpm.FetchPage(0));
+  EXPECT_EQ(true, bpm.UnpinPage(0, false));
+  // page 1 is the least recently used, it is dirty
+  ASSERT_NE(nullptr, bpm.NewPage(page_id));
+  EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+  ASSERT_NE(nullptr, bpm.FetchPage(1));
+  EXPECT_EQ(true, bpm.UnpinPage(1, false));
+
+  BufferPoolStats stats = bpm.GetStats();
+  EXPECT_EQ(1, stats.fetch_hits);
+  EXPECT_EQ(1, stats.fetch_misses);
+  EXPECT_EQ(0.5, stats.HitRatio());
+  EXPECT_EQ(2, stats.evictions);
+  EXPECT_EQ(2, stats.dirty_write_backs);
+  EXPECT_EQ(1, stats.new_page_failures);
+  EXPECT_EQ(1, stats.disk_read.count);
+  EXPECT_EQ(2, stats.disk_write.count);
+  EXPECT_LE(stats.disk_write.MeanNanos(),
+            stats.disk_write.PercentileNanos(1.0));
+  // the NewPage calls and the miss took the latch, hits and unpins did not
+  EXPECT_EQ(6, stats.latch_wait.count);
+
+  // counts from other threads are merged in
+  std::thread([&bpm] {
+    ASSERT_NE(nullptr, bpm.FetchPage(0));
+    bpm.UnpinPage(0, false);
+  }).join();
+  EXPECT_EQ(2, bpm.GetStats().fetch_hits);
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+// hits pin frames without the latch while misses evict them under it, every
+// thread must still see the contents of the page it asked for
+TEST(BufferPoolManagerTest, OptimisticHitTest) {
+  const int num_pages = 32;
+  const int num_threads = 4;
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(num_pages / 2, disk_manager);
+  for (int i = 0; i < num_pages; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+
+  std::vector<std::thread> threads;
+  std::atomic<int> errors(0);
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.push_back(std::thread([&bpm, &errors, tid] {
+      std::mt19937 rng(tid);
+      char expected[PAGE_SIZE];
+      for (int i = 0; i < 5000; ++i) {
+        // mostly the first few pages, so that there are hits and misses
+        page_id_t page_id = rng() % 4 == 0 ? rng() % num_pages : rng() % 8;
+        Page *page = bpm.FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        snprintf(expected, PAGE_SIZE, "page %d", page_id);
+        page->RLatch();
+        if (page->GetPageId() != page_id || strcmp(page->GetData(), expected) != 0) {
+          errors++;
+        }
+        page->RUnlatch();
+        if (!bpm.UnpinPage(page_id, false)) {
+          errors++;
+        }
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, errors);
+  BufferPoolStats stats = bpm.GetStats();
+  EXPECT_LT(0, stats.fetch_hits);
+  EXPECT_LT(0, stats.fetch_misses);
+  // every frame is unpinned again and can be reused
+  for (int i = 0; i < num_pages / 2; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+  }
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+// with all frames pinned, requests wait for one in arrival order, or give up
+// after the timeout
+TEST(BufferPoolManagerTest, FrameWaitTest) {
+  page_id_t temp_page_id;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(2, disk_manager);
+  ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+  ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+
+  bpm.SetFrameWaitTimeout(std::chrono::milliseconds(20));
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+  EXPECT_LE(std::chrono::milliseconds(20), std::chrono::steady_clock::now() - start);
+  EXPECT_EQ(1, bpm.GetStats().frame_wait_timeouts);
+
+  bpm.SetFrameWaitTimeout(std::chrono::milliseconds(10000));
+  std::atomic<int> served(0);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 2; ++tid) {
+    threads.push_back(std::thread([&bpm, &served] {
+      page_id_t page_id;
+      EXPECT_NE(nullptr, bpm.NewPage(page_id));
+      served++;
+    }));
+    // let the first one queue up before the second
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  EXPECT_EQ(0, served);
+  // the frame goes to the first one, though both are woken up
+  EXPECT_EQ(true, bpm.UnpinPage(0, false));
+  threads[0].join();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(1, served);
+  EXPECT_EQ(true, bpm.UnpinPage(1, false));
+  threads[1].join();
+  EXPECT_EQ(2, served);
+
+  BufferPoolStats stats = bpm.GetStats();
+  EXPECT_EQ(3, stats.frame_wait.count);
+  EXPECT_EQ(1, stats.frame_wait_timeouts);
+  EXPECT_EQ(1, stats.new_page_failures);
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+// all dirty pages are written in one batch, runs of adjacent pages are
+// split at the bitmap page of the second group
+TEST(BufferPoolManagerTest, FlushAllPagesTest) {
+  const int page_size = 512;
+  const int num_pages = page_size * 8 + 100;
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db", false, page_size);
+  BufferPoolManager bpm(num_pages, disk_manager);
+  for (int i = 0; i < num_pages; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), page_size, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+
+  bpm.FlushAllPages();
+  EXPECT_EQ(num_pages, bpm.GetStats().dirty_write_backs);
+  std::vector<char> data(page_size);
+  char expected[page_size];
+  for (int i = 0; i < num_pages; ++i) {
+    disk_manager->ReadPage(i, data.data());
+    snprintf(expected, page_size, "page %d", i);
+    EXPECT_EQ(0, strcmp(data.data(), expected));
+  }
+  // everything is clean now
+  bpm.FlushAllPages();
+  EXPECT_EQ(num_pages, bpm.GetStats().dirty_write_backs);
+
+  // compare with flushing page by page, both synced once at the end
+  for (int round = 0; round < 2; ++round) {
+    for (int i = 0; i < num_pages; ++i) {
+      ASSERT_NE(nullptr, bpm.FetchPage(i));
+      EXPECT_EQ(true, bpm.UnpinPage(i, true));
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (round == 0) {
+      for (int i = 0; i < num_pages; ++i) {
+        EXPECT_EQ(true, bpm.FlushPage(i));
+      }
+      disk_manager->SyncPages();
+    } else {
+      bpm.FlushAllPages();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    std::cout << (round == 0 ? "FlushPage: " : "FlushAllPages: ")
+              << elapsed.count() << "us for " << num_pages << " pages"
+              << std::endl;
+  }
+  EXPECT_EQ(3 * num_pages, bpm.GetStats().dirty_write_backs);
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+// the resident pages survive a restart, hottest first
+TEST(BufferPoolManagerTest, WarmUpTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(10, disk_manager);
+  for (int i = 0; i < 20; ++i) {
+    Page *page = bpm->NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(temp_page_id, true));
+  }
+  // 0..4 replace 10..14, and 17 stays pinned
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(17));
+  bpm->FlushAllPages();
+  bpm->SaveWarmupList();
+  EXPECT_EQ(std::vector<page_id_t>({17, 4, 3, 2, 1, 0, 19, 18, 16, 15}),
+            disk_manager->ReadWarmupList());
+  // deleted pages are not read in again
+  EXPECT_EQ(true, bpm->DeletePage(3));
+  EXPECT_EQ(true, bpm->UnpinPage(17, false));
+  delete bpm;
+  delete disk_manager;
+
+  // a smaller pool only gets the hottest pages
+  disk_manager = new DiskManager("test.db");
+  bpm = new BufferPoolManager(5, disk_manager);
+  EXPECT_EQ(5, bpm->WarmUp(true));
+  char expected[PAGE_SIZE];
+  for (page_id_t page_id : {17, 4, 2, 1, 0}) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  BufferPoolStats stats = bpm->GetStats();
+  EXPECT_EQ(5, stats.fetch_hits);
+  EXPECT_EQ(0, stats.fetch_misses);
+  // warming up takes free frames only
+  EXPECT_EQ(0, bpm->WarmUp(true));
+  delete bpm;
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.warm");
+}
+
 } // namespace scudb
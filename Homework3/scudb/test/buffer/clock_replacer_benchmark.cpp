@@ -0,0 +1,47 @@
+/**
+ * clock_replacer_benchmark.cpp
+ */
+
+#include <chrono>
+#include <iostream>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+// the hit path of the buffer pool: a frame is erased when pinned and
+// inserted again when unpinned, with an occasional eviction
+template <typename R> double HitPathNanos(R &replacer, int num_frames) {
+  const int ops = 1000000;
+  for (int i = 0; i < num_frames; ++i) {
+    replacer.Insert(i);
+  }
+  auto start = std::chrono::steady_clock::now();
+  int value;
+  for (int i = 0; i < ops; ++i) {
+    int frame = (int)((i * 7919LL) % num_frames);
+    replacer.Erase(frame);
+    replacer.Insert(frame);
+    if (i % 16 == 0 && replacer.Victim(value)) {
+      replacer.Insert(value);
+    }
+  }
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / ops;
+}
+
+TEST(ClockReplacerTest, HitPathBenchmark) {
+  const int num_frames = 1024;
+  LRUReplacer<int> lru_replacer;
+  ClockReplacer<int> clock_replacer(num_frames,
+                                    [](const int &v) { return (size_t)v; });
+  std::cout << "LRUReplacer ns/op: " << HitPathNanos(lru_replacer, num_frames)
+            << std::endl;
+  std::cout << "ClockReplacer ns/op: "
+            << HitPathNanos(clock_replacer, num_frames) << std::endl;
+}
+
+} // namespace scudb
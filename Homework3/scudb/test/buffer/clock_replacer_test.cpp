@@ -0,0 +1,140 @@
+/**
+ * clock_replacer_test.cpp
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/clock_replacer.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+TEST(ClockReplacerTest, SampleTest) {
+  ClockReplacer<int> clock_replacer(7, [](const int &v) { return (size_t)v; });
+
+  // push element into replacer
+  clock_replacer.Insert(1);
+  clock_replacer.Insert(2);
+  clock_replacer.Insert(3);
+  clock_replacer.Insert(4);
+  clock_replacer.Insert(5);
+  clock_replacer.Insert(6);
+  clock_replacer.Insert(1);
+  EXPECT_EQ(6, clock_replacer.Size());
+  EXPECT_EQ(std::vector<int>({6, 5, 4, 3, 2, 1}), clock_replacer.HotnessOrder());
+
+  // the first sweep clears every reference bit, then evicts in clock order
+  int value;
+  clock_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  // 3 is used again and gets a second chance
+  clock_replacer.Insert(3);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(4, value);
+
+  // remove element from replacer
+  EXPECT_EQ(false, clock_replacer.Erase(4));
+  EXPECT_EQ(true, clock_replacer.Erase(6));
+  EXPECT_EQ(2, clock_replacer.Size());
+
+  clock_replacer.Victim(value);
+  EXPECT_EQ(5, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+  EXPECT_EQ(false, clock_replacer.Victim(value));
+}
+
+// a recorded access gives a candidate a second chance, like inserting it again
+TEST(ClockReplacerTest, RecordAccessTest) {
+  ClockReplacer<int> clock_replacer(4, [](const int &v) { return (size_t)v; });
+  for (int i = 0; i < 4; ++i) {
+    clock_replacer.Insert(i);
+  }
+
+  // the first sweep clears every reference bit
+  int value;
+  clock_replacer.Victim(value);
+  EXPECT_EQ(0, value);
+  clock_replacer.RecordAccess(1);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(false, clock_replacer.Victim(value));
+}
+
+// hits keep setting the reference bit of a single slot between the two
+// passes of the hand, a sweep still ends with that slot as the victim
+TEST(ClockReplacerTest, ConcurrentRecordAccessTest) {
+  const int num_threads = 4;
+  ClockReplacer<int> clock_replacer(1, [](const int &v) { return (size_t)v; });
+  std::atomic<int> started(0);
+  std::atomic<bool> done(false);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.push_back(std::thread([&clock_replacer, &started, &done] {
+      started++;
+      while (!done) {
+        clock_replacer.RecordAccess(0);
+      }
+    }));
+  }
+  while (started < num_threads) {
+    std::this_thread::yield();
+  }
+  int value;
+  for (int round = 0; round < 100000; ++round) {
+    clock_replacer.Insert(0);
+    value = -1;
+    ASSERT_EQ(true, round % 2 == 0
+                        ? clock_replacer.Victim(value)
+                        : clock_replacer.VictimPreferring(
+                              value, [](const int &) { return false; }));
+    ASSERT_EQ(0, value);
+    ASSERT_EQ(0, clock_replacer.Size());
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+TEST(ClockReplacerTest, BufferPoolTest) {
+  page_id_t temp_page_id;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager, nullptr, ReplacerType::CLOCK);
+
+  auto page_zero = bpm.NewPage(temp_page_id);
+  ASSERT_NE(nullptr, page_zero);
+  strcpy(page_zero->GetData(), "Hello");
+  for (int i = 1; i < 10; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  }
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, true));
+  }
+  for (int i = 10; i < 15; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  }
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+  page_zero = bpm.FetchPage(0);
+  EXPECT_EQ(nullptr, page_zero);
+  EXPECT_EQ(true, bpm.UnpinPage(14, false));
+  page_zero = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page_zero);
+  EXPECT_EQ(0, strcmp(page_zero->GetData(), "Hello"));
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+} // namespace scudb
@@ -0,0 +1,40 @@
+/**
+ * frame_arena_test.cpp
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include "buffer/frame_arena.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+// every frame is aligned to the page size and they do not overlap, for small
+// arenas and for ones large enough to go on huge pages
+TEST(FrameArenaTest, SampleTest) {
+  for (int page_size : {512, 4096, 64 * 1024}) {
+    for (size_t num_frames : {(size_t)1, (size_t)10, (size_t)1024}) {
+      FrameArena arena(num_frames, page_size);
+      for (size_t i = 0; i < num_frames; ++i) {
+        char *frame = arena.GetFrame(i);
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(frame) % page_size);
+        memset(frame, static_cast<int>(i % 128), page_size);
+      }
+      for (size_t i = 0; i < num_frames; ++i) {
+        char *frame = arena.GetFrame(i);
+        EXPECT_EQ(static_cast<char>(i % 128), frame[0]);
+        EXPECT_EQ(static_cast<char>(i % 128), frame[page_size - 1]);
+      }
+      if (num_frames * page_size >= 2 * 1024 * 1024) {
+        std::cout << num_frames << " frames of " << page_size << " bytes"
+                  << (arena.IsHugePageBacked() ? " on reserved huge pages"
+                                               : " on regular pages")
+                  << std::endl;
+      }
+    }
+  }
+}
+
+} // namespace scudb
@@ -0,0 +1,206 @@
+/**
+ * lru_k_replacer_test.cpp
+ */
+
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer<int> lru_k_replacer(7, [](const int &v) { return (size_t)v; });
+
+  // 1..5 are accessed once, 6 twice, 1 once more
+  for (int i = 1; i <= 6; ++i) {
+    lru_k_replacer.RecordAccess(i);
+    lru_k_replacer.Insert(i);
+  }
+  lru_k_replacer.RecordAccess(6);
+  lru_k_replacer.RecordAccess(1);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+  EXPECT_EQ(std::vector<int>({6, 1, 5, 4, 3, 2}), lru_k_replacer.HotnessOrder());
+
+  // pages with fewer than two accesses go first, oldest first
+  int value;
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(4, value);
+
+  // erased values are no candidates, but keep their history
+  EXPECT_EQ(false, lru_k_replacer.Erase(4));
+  EXPECT_EQ(true, lru_k_replacer.Erase(5));
+  EXPECT_EQ(2, lru_k_replacer.Size());
+  lru_k_replacer.Insert(5);
+
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(5, value);
+  // second most recent access of 1 is older than the one of 6
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(6, value);
+  EXPECT_EQ(false, lru_k_replacer.Victim(value));
+}
+
+// accesses recorded from many threads at once, as the hit path of the buffer
+// pool does without a latch, all count
+TEST(LRUKReplacerTest, ConcurrentRecordAccessTest) {
+  const int num_threads = 8;
+  LRUKReplacer<int> lru_k_replacer(num_threads + 1,
+                                   [](const int &v) { return (size_t)v; });
+  lru_k_replacer.RecordAccess(num_threads);
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.push_back(std::thread([&lru_k_replacer, tid] {
+      for (int i = 0; i < 10000; ++i) {
+        lru_k_replacer.RecordAccess(tid);
+        lru_k_replacer.RecordAccess(i % num_threads);
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int i = 0; i <= num_threads; ++i) {
+    lru_k_replacer.Insert(i);
+  }
+
+  // the only value used once goes first
+  int value;
+  EXPECT_EQ(true, lru_k_replacer.Victim(value));
+  EXPECT_EQ(num_threads, value);
+  EXPECT_EQ(num_threads, lru_k_replacer.Size());
+}
+
+// hot pages that were used twice survive a scan over many more pages than
+// the pool can hold
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  const int pool_size = 10;
+  const int num_hot = 5;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(pool_size, disk_manager, nullptr, ReplacerType::LRU_K);
+
+  page_id_t page_id;
+  for (int i = 0; i < 50; ++i) {
+    Page *page = bpm.NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm.UnpinPage(page_id, true);
+  }
+  for (int i = 0; i < num_hot; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      ASSERT_NE(nullptr, bpm.FetchPage(i));
+      bpm.UnpinPage(i, false);
+    }
+  }
+  // scan
+  for (int i = num_hot; i < 50; ++i) {
+    ASSERT_NE(nullptr, bpm.FetchPage(i));
+    bpm.UnpinPage(i, false);
+  }
+
+  // a resident page is returned without reading the disk
+  char garbage[PAGE_SIZE] = "garbage";
+  for (int i = 0; i < num_hot; ++i) {
+    disk_manager->WritePage(i, garbage);
+  }
+  for (int i = 0; i < num_hot; ++i) {
+    char expected[PAGE_SIZE];
+    snprintf(expected, PAGE_SIZE, "page %d", i);
+    Page *page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    bpm.UnpinPage(i, false);
+  }
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+// a deleted page leaves no history behind in its frame: the page that gets
+// the frame next has been used once and is evicted before a page used twice
+TEST(LRUKReplacerTest, DeletePageTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(2, disk_manager, nullptr, ReplacerType::LRU_K);
+
+  page_id_t page_zero, page_one, page_two, page_three;
+  ASSERT_NE(nullptr, bpm.NewPage(page_zero));
+  ASSERT_NE(nullptr, bpm.NewPage(page_one));
+  ASSERT_NE(nullptr, bpm.FetchPage(page_one));
+  ASSERT_NE(nullptr, bpm.FetchPage(page_zero));
+  for (int i = 0; i < 2; ++i) {
+    bpm.UnpinPage(page_zero, false);
+    bpm.UnpinPage(page_one, false);
+  }
+  EXPECT_EQ(true, bpm.DeletePage(page_zero));
+  ASSERT_NE(nullptr, bpm.NewPage(page_two));
+  bpm.UnpinPage(page_two, false);
+
+  ASSERT_NE(nullptr, bpm.NewPage(page_three));
+  bpm.UnpinPage(page_three, false);
+  ASSERT_NE(nullptr, bpm.FetchPage(page_one));
+  bpm.UnpinPage(page_one, false);
+  EXPECT_EQ(0u, bpm.GetStats().fetch_misses);
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+// a bulk read recycles the frames of its ring, and every page it puts there
+// starts without history; otherwise a frame that went around the ring
+// LRUK_REPLACER_K times would look hotter than the pages used over and over
+TEST(LRUKReplacerTest, RingRecycleTest) {
+  const int pool_size = 64;
+  const int num_hot = 56;
+  const int num_pages = 200;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(pool_size, disk_manager, nullptr, ReplacerType::LRU_K);
+
+  page_id_t page_id;
+  for (int i = 0; i < num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(page_id));
+    bpm.UnpinPage(page_id, false);
+  }
+  // the hot pages fill all but a few frames, those hold pages used once
+  for (int i = 0; i < num_hot; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      ASSERT_NE(nullptr, bpm.FetchPage(i));
+      bpm.UnpinPage(i, false);
+    }
+  }
+  // new pages are dirty, and clean ones are evicted first
+  bpm.FlushAllPages();
+  // a scan that goes around the ring many times
+  for (int i = num_hot; i < 136; ++i) {
+    ASSERT_NE(nullptr, bpm.FetchPage(i, AccessStrategy::BULK_READ));
+    bpm.UnpinPage(i, false);
+  }
+  // new hot pages take the frames of the scan
+  for (int i = 136; i < 144; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      ASSERT_NE(nullptr, bpm.FetchPage(i));
+      bpm.UnpinPage(i, false);
+    }
+  }
+
+  uint64_t misses = bpm.GetStats().fetch_misses;
+  for (int i = 0; i < num_hot; ++i) {
+    ASSERT_NE(nullptr, bpm.FetchPage(i));
+    bpm.UnpinPage(i, false);
+  }
+  EXPECT_EQ(misses, bpm.GetStats().fetch_misses);
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+} // namespace scudb
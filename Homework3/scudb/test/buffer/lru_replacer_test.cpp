@@ -3,6 +3,7 @@
  */
 
 #include <cstdio>
+#include <vector>
 
 #include "buffer/lru_replacer.h"
 #include "gtest/gtest.h"
@@ -21,6 +22,7 @@ TEST(LRUReplacerTest, SampleTest) {
   lru_replacer.Insert(6);
   lru_replacer.Insert(1);
   EXPECT_EQ(6, lru_replacer.Size());
+  EXPECT_EQ(std::vector<int>({1, 6, 5, 4, 3, 2}), lru_replacer.HotnessOrder());
   
   // pop element from replacer
   int value;
@@ -0,0 +1,69 @@
+/**
+ * parallel_buffer_pool_manager_benchmark.cpp
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+// fetch/unpin random resident pages from several threads and report the
+// throughput of a single pool versus a pool split into instances
+TEST(ParallelBufferPoolManagerTest, ScalingBenchmark) {
+  const size_t pool_size = 64;
+  const int ops_per_thread = 20000;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  for (size_t num_instances : {(size_t)1, (size_t)16}) {
+    BufferPoolManager *bpm =
+        num_instances == 1
+            ? new BufferPoolManager(pool_size, disk_manager)
+            : new ParallelBufferPoolManager(num_instances, pool_size,
+                                            disk_manager);
+    std::vector<page_id_t> page_ids(pool_size);
+    for (size_t i = 0; i < pool_size; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(page_ids[i]));
+      bpm->UnpinPage(page_ids[i], false);
+    }
+
+    for (int num_threads = 1; num_threads <= 16; num_threads *= 2) {
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> threads;
+      for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+          std::mt19937 gen(t);
+          for (int i = 0; i < ops_per_thread; ++i) {
+            page_id_t page_id = page_ids[gen() % pool_size];
+            Page *page = bpm->FetchPage(page_id);
+            EXPECT_NE(nullptr, page);
+            bpm->UnpinPage(page_id, false);
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+      std::cout << "instances: " << num_instances
+                << " threads: " << num_threads << " ops/sec: "
+                << (int64_t)(num_threads * ops_per_thread / elapsed.count())
+                << std::endl;
+    }
+    std::cout << bpm->GetStats().ToString() << std::endl;
+    delete bpm;
+  }
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace scudb
@@ -0,0 +1,101 @@
+/**
+ * parallel_buffer_pool_manager_test.cpp
+ */
+
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  ParallelBufferPoolManager bpm(5, 10, disk_manager);
+  EXPECT_EQ(5, bpm.GetNumInstances());
+  EXPECT_EQ(10, bpm.GetPoolSize());
+
+  auto page_zero = bpm.NewPage(temp_page_id);
+  ASSERT_NE(nullptr, page_zero);
+  EXPECT_EQ(0, temp_page_id);
+  strcpy(page_zero->GetData(), "Hello");
+
+  for (int i = 1; i < 10; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(i, temp_page_id);
+  }
+  // all the pages are pinned, every instance is full
+  for (int i = 10; i < 15; ++i) {
+    EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+  }
+  EXPECT_EQ(5, bpm.GetStats().new_page_failures);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, true));
+  }
+  // the dirty pages of all instances are written as one batch
+  bpm.FlushAllPages();
+  EXPECT_EQ(10, bpm.GetStats().dirty_write_backs);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+  }
+  // page zero was evicted and has to be read back from disk
+  page_zero = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page_zero);
+  EXPECT_EQ(0, strcmp(page_zero->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm.UnpinPage(0, false));
+  EXPECT_EQ(false, bpm.UnpinPage(0, false));
+  EXPECT_EQ(true, bpm.DeletePage(0));
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// fetch/unpin random resident pages from several threads; every fetch of a
+// resident page must succeed whichever instance it maps to
+TEST(ParallelBufferPoolManagerTest, ConcurrentFetchTest) {
+  const size_t pool_size = 64;
+  const int num_threads = 8;
+  const int ops_per_thread = 2000;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  ParallelBufferPoolManager bpm(16, pool_size, disk_manager);
+  std::vector<page_id_t> page_ids(pool_size);
+  for (size_t i = 0; i < pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(page_ids[i]));
+    bpm.UnpinPage(page_ids[i], false);
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      std::mt19937 gen(t);
+      for (int i = 0; i < ops_per_thread; ++i) {
+        page_id_t page_id = page_ids[gen() % pool_size];
+        Page *page = bpm.FetchPage(page_id);
+        EXPECT_NE(nullptr, page);
+        if (page != nullptr) {
+          EXPECT_EQ(page_id, page->GetPageId());
+          bpm.UnpinPage(page_id, false);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  // every page stayed resident, nothing had to be read back
+  EXPECT_EQ(0u, bpm.GetStats().fetch_misses);
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace scudb
@@ -0,0 +1,208 @@
+/**
+ * disk_manager_test.cpp
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "common/exception.h"
+#include "disk/disk_manager.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+TEST(DiskManagerTest, ReadWriteTest) {
+  for (bool direct_io : {false, true}) {
+    DiskManager *disk_manager = new DiskManager("test.db", direct_io);
+    char data[PAGE_SIZE];
+    char buffer[PAGE_SIZE];
+
+    // reading beyond the end of file gives a zeroed page
+    memset(buffer, 'x', PAGE_SIZE);
+    disk_manager->ReadPage(0, buffer);
+    for (int i = 0; i < PAGE_SIZE; ++i) {
+      EXPECT_EQ(0, buffer[i]);
+    }
+
+    for (int page_id = 0; page_id < 10; ++page_id) {
+      memset(data, 'a' + page_id, PAGE_SIZE);
+      disk_manager->WritePage(page_id, data);
+    }
+    // both aligned and unaligned memory
+    void *aligned = nullptr;
+    ASSERT_EQ(0, posix_memalign(&aligned, PAGE_SIZE, PAGE_SIZE));
+    for (char *page_data : {buffer + 0, static_cast<char *>(aligned)}) {
+      for (int page_id = 9; page_id >= 0; --page_id) {
+        memset(data, 'a' + page_id, PAGE_SIZE);
+        disk_manager->ReadPage(page_id, page_data);
+        EXPECT_EQ(0, memcmp(data, page_data, PAGE_SIZE));
+      }
+    }
+    free(aligned);
+
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+// readers and writers of different pages do not interfere
+TEST(DiskManagerTest, ConcurrentTest) {
+  const int num_threads = 4;
+  const int pages_per_thread = 50;
+  DiskManager *disk_manager = new DiskManager("test.db");
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([disk_manager, t] {
+      char data[PAGE_SIZE];
+      char buffer[PAGE_SIZE];
+      for (int round = 0; round < 5; ++round) {
+        for (int i = 0; i < pages_per_thread; ++i) {
+          page_id_t page_id = i * num_threads + t;
+          snprintf(data, PAGE_SIZE, "page %d round %d", page_id, round);
+          disk_manager->WritePage(page_id, data);
+        }
+        for (int i = 0; i < pages_per_thread; ++i) {
+          page_id_t page_id = i * num_threads + t;
+          snprintf(data, PAGE_SIZE, "page %d round %d", page_id, round);
+          disk_manager->ReadPage(page_id, buffer);
+          EXPECT_EQ(0, strcmp(data, buffer));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// many asynchronous reads and writes in flight at once, more than the queue
+// depth
+TEST(DiskManagerTest, AsyncTest) {
+  const int num_pages = 3 * ASYNC_IO_DEPTH;
+  for (bool direct_io : {false, true}) {
+    DiskManager *disk_manager = new DiskManager("test.db", direct_io);
+    void *memory = nullptr;
+    ASSERT_EQ(0, posix_memalign(&memory, PAGE_SIZE, num_pages * PAGE_SIZE));
+    char *pages = static_cast<char *>(memory);
+
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < num_pages; ++i) {
+      snprintf(pages + i * PAGE_SIZE, PAGE_SIZE, "page %d", i);
+      futures.push_back(
+          disk_manager->WritePageAsync(i, pages + i * PAGE_SIZE));
+    }
+    for (auto &future : futures) {
+      future.wait();
+    }
+    futures.clear();
+
+    memset(pages, 'x', num_pages * PAGE_SIZE);
+    for (int i = 0; i < num_pages; ++i) {
+      futures.push_back(disk_manager->ReadPageAsync(i, pages + i * PAGE_SIZE));
+    }
+    // reading at the end of file gives a zeroed page
+    char buffer[PAGE_SIZE];
+    memset(buffer, 'x', PAGE_SIZE);
+    disk_manager->ReadPageAsync(num_pages, buffer).wait();
+    for (int i = 0; i < PAGE_SIZE; ++i) {
+      EXPECT_EQ(0, buffer[i]);
+    }
+    for (auto &future : futures) {
+      future.wait();
+    }
+    for (int i = 0; i < num_pages; ++i) {
+      char expected[PAGE_SIZE];
+      snprintf(expected, PAGE_SIZE, "page %d", i);
+      EXPECT_EQ(0, strcmp(expected, pages + i * PAGE_SIZE));
+    }
+
+    free(memory);
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+// deallocated pages are reused, and allocations survive a restart, also
+// across several bitmap pages
+TEST(DiskManagerTest, AllocateTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  const int pages_per_bitmap = disk_manager->GetPagesPerBitmap();
+  const int num_pages = pages_per_bitmap + 100;
+  for (int i = 0; i < num_pages; ++i) {
+    EXPECT_EQ(i, disk_manager->AllocatePage());
+  }
+  disk_manager->DeallocatePage(5);
+  disk_manager->DeallocatePage(3);
+  disk_manager->DeallocatePage(pages_per_bitmap + 1);
+  EXPECT_EQ(3, disk_manager->AllocatePage());
+  EXPECT_EQ(5, disk_manager->AllocatePage());
+  EXPECT_EQ(pages_per_bitmap + 1, disk_manager->AllocatePage());
+  EXPECT_EQ(num_pages, disk_manager->AllocatePage());
+
+  // the pages on both sides of a bitmap page stay apart
+  char data[PAGE_SIZE];
+  char buffer[PAGE_SIZE];
+  for (int i = pages_per_bitmap - 1; i <= pages_per_bitmap; ++i) {
+    snprintf(data, PAGE_SIZE, "page %d", i);
+    disk_manager->WritePage(i, data);
+  }
+  disk_manager->DeallocatePage(7);
+  disk_manager->DeallocatePage(pages_per_bitmap + 2);
+  delete disk_manager;
+
+  disk_manager = new DiskManager("test.db");
+  for (int i = pages_per_bitmap - 1; i <= pages_per_bitmap; ++i) {
+    snprintf(data, PAGE_SIZE, "page %d", i);
+    disk_manager->ReadPage(i, buffer);
+    EXPECT_EQ(0, strcmp(data, buffer));
+  }
+  EXPECT_EQ(7, disk_manager->AllocatePage());
+  EXPECT_EQ(pages_per_bitmap + 2, disk_manager->AllocatePage());
+  EXPECT_EQ(num_pages + 1, disk_manager->AllocatePage());
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// a file whose second page is not a bitmap page of this layout, such as one
+// written before bitmap pages were interleaved with the data, is rejected
+TEST(DiskManagerTest, LayoutVersionTest) {
+  char data[PAGE_SIZE];
+  DiskManager *disk_manager = new DiskManager("test.db");
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(i, disk_manager->AllocatePage());
+    snprintf(data, PAGE_SIZE, "page %d", i);
+    disk_manager->WritePage(i, data);
+  }
+  delete disk_manager;
+  // reopening a file of this layout works
+  disk_manager = new DiskManager("test.db");
+  EXPECT_EQ(3, disk_manager->AllocatePage());
+  delete disk_manager;
+
+  // overwrite the bitmap page with data, as the old layout had it there
+  FILE *file = fopen("test.db", "r+b");
+  ASSERT_NE(nullptr, file);
+  memset(data, 'x', PAGE_SIZE);
+  ASSERT_EQ(0, fseek(file, PAGE_SIZE, SEEK_SET));
+  ASSERT_EQ(1u, fwrite(data, PAGE_SIZE, 1, file));
+  fclose(file);
+  EXPECT_THROW(new DiskManager("test.db"), Exception);
+
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace scudb
@@ -0,0 +1,59 @@
+/**
+ * linear_probe_hash_table_benchmark.cpp
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "common/config.h"
+#include "hash/extendible_hash.h"
+#include "hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+// lookups of resident pages from 16 threads, as a page table sees them
+TEST(LinearProbeHashTableTest, LookupBenchmark) {
+  const int num_keys = 1024;
+  const int num_threads = 16;
+  const int lookups_per_thread = 200000;
+
+  for (int table = 0; table < 2; ++table) {
+    HashTable<int, int> *test;
+    if (table == 0) {
+      test = new ExtendibleHash<int, int>(BUCKET_SIZE);
+    } else {
+      test = new LinearProbeHashTable<int, int>(num_keys);
+    }
+    for (int i = 0; i < num_keys; ++i) {
+      test->Insert(i, i);
+    }
+
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int tid = 0; tid < num_threads; ++tid) {
+      threads.push_back(std::thread([test, tid] {
+        int value;
+        for (int i = 0; i < lookups_per_thread; ++i) {
+          int key = (i * 7 + tid) % num_keys;
+          EXPECT_EQ(true, test->Find(key, value));
+        }
+      }));
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    std::cout << (table == 0 ? "ExtendibleHash: " : "LinearProbeHashTable: ")
+              << num_threads * lookups_per_thread * 1000.0 /
+                     std::max<long>(elapsed.count(), 1)
+              << " lookups/s" << std::endl;
+    delete test;
+  }
+}
+
+} // namespace scudb
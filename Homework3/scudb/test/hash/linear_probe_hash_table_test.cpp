@@ -0,0 +1,102 @@
+/**
+ * linear_probe_hash_table_test.cpp
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+TEST(LinearProbeHashTableTest, SampleTest) {
+  LinearProbeHashTable<int, int> test(100);
+  EXPECT_EQ(100, test.GetCapacity());
+
+  for (int i = 0; i < 100; ++i) {
+    test.Insert(i, i * 10);
+  }
+  EXPECT_EQ(100, test.Size());
+  int result = 0;
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(true, test.Find(i, result));
+    EXPECT_EQ(i * 10, result);
+  }
+  EXPECT_EQ(false, test.Find(100, result));
+
+  // insert overwrites
+  test.Insert(5, 42);
+  EXPECT_EQ(100, test.Size());
+  EXPECT_EQ(true, test.Find(5, result));
+  EXPECT_EQ(42, result);
+
+  // remove every other key, the rest must still be found behind the holes
+  for (int i = 0; i < 100; i += 2) {
+    EXPECT_EQ(true, test.Remove(i));
+  }
+  EXPECT_EQ(false, test.Remove(0));
+  EXPECT_EQ(50, test.Size());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(i % 2 == 1, test.Find(i, result));
+  }
+
+  // churn through many more keys than the capacity, as a page table does
+  for (int i = 1; i < 100; i += 2) {
+    EXPECT_EQ(true, test.Remove(i));
+  }
+  EXPECT_EQ(0, test.Size());
+  for (int i = 0; i < 10000; ++i) {
+    test.Insert(i, i);
+    if (i >= 50) {
+      EXPECT_EQ(true, test.Remove(i - 50));
+    }
+  }
+  EXPECT_EQ(50, test.Size());
+  for (int i = 9950; i < 10000; ++i) {
+    EXPECT_EQ(true, test.Find(i, result));
+    EXPECT_EQ(i, result);
+  }
+}
+
+// readers never miss a key that stays in the table while a writer inserts and
+// removes others around it
+TEST(LinearProbeHashTableTest, ConcurrentFindTest) {
+  const int num_stable = 32;
+  LinearProbeHashTable<int, int> test(64);
+  for (int i = 0; i < num_stable; ++i) {
+    test.Insert(i, i);
+  }
+
+  std::atomic<bool> done(false);
+  std::thread writer([&] {
+    for (int round = 0; round < 20000; ++round) {
+      int key = num_stable + round % 32;
+      test.Insert(key, round);
+      test.Remove(key);
+    }
+    done = true;
+  });
+  std::vector<std::thread> readers;
+  std::atomic<int> misses(0);
+  for (int tid = 0; tid < 4; ++tid) {
+    readers.push_back(std::thread([&] {
+      int value;
+      while (!done) {
+        for (int i = 0; i < num_stable; ++i) {
+          if (!test.Find(i, value) || value != i) {
+            misses++;
+          }
+        }
+      }
+    }));
+  }
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, misses);
+}
+
+} // namespace scudb
@@ -0,0 +1,177 @@
+/**
+ * logged_pages.h
+ *
+ * Helpers of the recovery tests and benchmarks
+ */
+
+#pragma once
+
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "logging/log_manager.h"
+#include "page/table_page.h"
+#include "table/tuple.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+// changes table pages and writes their log records like TablePage and
+// TransactionManager do with logging on, without the lock manager; with a
+// transaction manager, which numbers the transactions from 0 in the order
+// they begin, that one begins and commits them
+class LoggedPages {
+public:
+  LoggedPages(BufferPoolManager *bpm, LogManager *log_manager,
+              TransactionManager *txn_manager = nullptr)
+      : bpm_(bpm), log_manager_(log_manager), txn_manager_(txn_manager),
+        last_lsn_(INVALID_LSN) {}
+
+  void Begin(txn_id_t txn_id) {
+    if (txn_manager_ != nullptr) {
+      // it logs only with logging on, which TablePage can not have here
+      ENABLE_LOGGING = true;
+      Transaction *txn = txn_manager_->Begin();
+      ENABLE_LOGGING = false;
+      EXPECT_EQ(txn_id, txn->GetTransactionId());
+      txns_[txn_id] = txn;
+      last_lsn_ = prev_lsns_[txn_id] = txn->GetPrevLSN();
+      return;
+    }
+    LogRecord record(txn_id, INVALID_LSN, LogRecordType::BEGIN);
+    Append(record, nullptr);
+  }
+
+  void Commit(txn_id_t txn_id) {
+    if (txn_manager_ != nullptr) {
+      Transaction *txn = txns_[txn_id];
+      ENABLE_LOGGING = true;
+      txn_manager_->Commit(txn);
+      ENABLE_LOGGING = false;
+      last_lsn_ = txn->GetPrevLSN();
+      txns_.erase(txn_id);
+      delete txn;
+      return;
+    }
+    LogRecord record(txn_id, prev_lsns_[txn_id], LogRecordType::COMMIT);
+    Append(record, nullptr);
+  }
+
+  page_id_t NewPage(txn_id_t txn_id, page_id_t prev_page_id) {
+    page_id_t page_id;
+    WritePageGuard guard(bpm_, bpm_->NewPage(page_id));
+    auto page = static_cast<TablePage *>(guard.GetPage());
+    page->Init(page_id, page->GetPageSize(), prev_page_id, nullptr, nullptr);
+    LogRecord record(txn_id, prev_lsns_[txn_id], LogRecordType::NEWPAGE,
+                     prev_page_id, page_id);
+    Append(record, page);
+    guard.MarkDirty();
+    if (prev_page_id != INVALID_PAGE_ID) {
+      WritePageGuard prev_guard = bpm_->FetchPageWrite(prev_page_id);
+      static_cast<TablePage *>(prev_guard.GetPage())->SetNextPageId(page_id);
+      prev_guard.MarkDirty();
+    }
+    return page_id;
+  }
+
+  bool Insert(txn_id_t txn_id, page_id_t page_id, const Tuple &tuple,
+              RID &rid) {
+    WritePageGuard guard = bpm_->FetchPageWrite(page_id);
+    auto page = static_cast<TablePage *>(guard.GetPage());
+    if (!page->InsertTuple(tuple, rid, nullptr, nullptr, nullptr)) {
+      return false;
+    }
+    LogRecord record(txn_id, prev_lsns_[txn_id], LogRecordType::INSERT, rid,
+                     tuple);
+    Append(record, page);
+    guard.MarkDirty();
+    return true;
+  }
+
+  bool Update(txn_id_t txn_id, const RID &rid, const Tuple &tuple,
+              bool allow_delta = true) {
+    WritePageGuard guard = bpm_->FetchPageWrite(rid.GetPageId());
+    auto page = static_cast<TablePage *>(guard.GetPage());
+    Tuple old_tuple;
+    if (!page->UpdateTuple(tuple, old_tuple, rid, nullptr, nullptr,
+                           nullptr)) {
+      return false;
+    }
+    LogRecord record(txn_id, prev_lsns_[txn_id], LogRecordType::UPDATE, rid,
+                     old_tuple, tuple, allow_delta);
+    Append(record, page);
+    guard.MarkDirty();
+    return true;
+  }
+
+  void MarkDelete(txn_id_t txn_id, const RID &rid) {
+    WritePageGuard guard = bpm_->FetchPageWrite(rid.GetPageId());
+    auto page = static_cast<TablePage *>(guard.GetPage());
+    EXPECT_TRUE(page->MarkDelete(rid, nullptr, nullptr, nullptr));
+    LogRecord record(txn_id, prev_lsns_[txn_id], LogRecordType::MARKDELETE,
+                     rid, Tuple());
+    Append(record, page);
+    guard.MarkDirty();
+  }
+
+  // MarkDelete() and the ApplyDelete() of the commit at once
+  void Delete(txn_id_t txn_id, const RID &rid) {
+    Tuple tuple;
+    {
+      ReadPageGuard guard = bpm_->FetchPageRead(rid.GetPageId());
+      EXPECT_TRUE(static_cast<TablePage *>(guard.GetPage())
+                      ->GetTuple(rid, tuple, nullptr, nullptr));
+    }
+    MarkDelete(txn_id, rid);
+    WritePageGuard guard = bpm_->FetchPageWrite(rid.GetPageId());
+    auto page = static_cast<TablePage *>(guard.GetPage());
+    page->ApplyDelete(rid, nullptr, nullptr);
+    LogRecord record(txn_id, prev_lsns_[txn_id], LogRecordType::APPLYDELETE,
+                     rid, tuple);
+    Append(record, page);
+    guard.MarkDirty();
+  }
+
+  lsn_t GetLastLSN() const { return last_lsn_; }
+
+private:
+  void Append(LogRecord &record, TablePage *page) {
+    last_lsn_ = log_manager_->AppendLogRecord(record);
+    prev_lsns_[record.GetTxnId()] = last_lsn_;
+    auto iter = txns_.find(record.GetTxnId());
+    if (iter != txns_.end()) {
+      iter->second->SetPrevLSN(last_lsn_);
+    }
+    if (page != nullptr) {
+      page->SetLSN(last_lsn_);
+    }
+  }
+
+  BufferPoolManager *bpm_;
+  LogManager *log_manager_;
+  TransactionManager *txn_manager_;
+  std::unordered_map<txn_id_t, lsn_t> prev_lsns_;
+  // still running, with a transaction manager
+  std::unordered_map<txn_id_t, Transaction *> txns_;
+  lsn_t last_lsn_;
+};
+
+bool SameTuple(const Tuple &a, const Tuple &b) {
+  return a.GetLength() == b.GetLength() &&
+         memcmp(a.GetData(), b.GetData(), a.GetLength()) == 0;
+}
+
+// tuple with column column_id set to value
+Tuple SetColumn(const Tuple &tuple, Schema *schema, int column_id,
+                const Value &value) {
+  std::vector<Value> values;
+  for (int i = 0; i < schema->GetColumnCount(); ++i) {
+    values.push_back(i == column_id ? value : tuple.GetValue(schema, i));
+  }
+  return Tuple(values, schema);
+}
+
+} // namespace scudb
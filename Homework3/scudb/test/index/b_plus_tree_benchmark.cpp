@@ -0,0 +1,72 @@
+/**
+ * b_plus_tree_benchmark.cpp
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+
+#include "buffer/buffer_pool_manager.h"
+#include "index/b_plus_tree.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+// random point lookups in trees built on different page sizes, with the same
+// number of frames in the pool
+TEST(BPlusTreeTests, PageSizeBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t scale = 20000;
+  const int lookups = 20000;
+
+  for (int page_size : {512, 4096, 16384}) {
+    DiskManager *disk_manager = new DiskManager("test.db", false, page_size);
+    BufferPoolManager *bpm = new BufferPoolManager(30, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                             comparator);
+    GenericKey<8> index_key;
+    RID rid;
+    Transaction *transaction = new Transaction(0);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(page_id);
+    (void)header_page;
+
+    for (int64_t key = 1; key <= scale; key++) {
+      rid.Set((int32_t)(key >> 32), key & 0xFFFFFFFF);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
+    // number of pages the tree occupies
+    bpm->NewPage(page_id);
+    bpm->UnpinPage(page_id, false);
+
+    std::mt19937 gen(0);
+    std::vector<RID> rids;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < lookups; ++i) {
+      int64_t key = gen() % scale + 1;
+      rids.clear();
+      index_key.SetFromInteger(key);
+      tree.GetValue(index_key, rids);
+      EXPECT_EQ(1, rids.size());
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::cout << "page size: " << page_size << " pages: " << page_id
+              << " ns/lookup: " << (int64_t)(elapsed.count() / lookups)
+              << std::endl;
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete transaction;
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+} // namespace scudb
@@ -3,9 +3,11 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <iostream>
 #include <sstream>
+#include <thread>
 
 #include "buffer/buffer_pool_manager.h"
 #include "common/logger.h"
@@ -390,4 +392,124 @@ TEST(BPlusTreeTests, ScaleTest) {
   remove("test.db");
   remove("test.log");
 }
+
+// an insertion that cannot get pages for its split throws and leaves the tree
+// as it was; with frame waiting enabled it gets them once they are unpinned
+TEST(BPlusTreeTests, OutOfFramesTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(10, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  GenericKey<8> index_key;
+  RID rid;
+  Transaction *transaction = new Transaction(0);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void)header_page;
+
+  // the first insertion creates the root leaf, then pin the other frames
+  int64_t key = 1;
+  index_key.SetFromInteger(key);
+  rid.Set(0, key);
+  tree.Insert(index_key, rid, transaction);
+  std::vector<page_id_t> pinned;
+  while (bpm->NewPage(page_id) != nullptr) {
+    pinned.push_back(page_id);
+  }
+  // that evicted the root leaf, leave one frame to read it back into
+  bpm->UnpinPage(pinned.back(), false);
+  pinned.pop_back();
+  EXPECT_EQ(8, pinned.size());
+
+  // fill the leaf until it has to split
+  bool thrown = false;
+  for (key = 2; key < 1000 && !thrown; key++) {
+    index_key.SetFromInteger(key);
+    rid.Set(0, key);
+    try {
+      tree.Insert(index_key, rid, transaction);
+    } catch (Exception &e) {
+      thrown = true;
+    }
+  }
+  ASSERT_TRUE(thrown);
+  int64_t failed_key = key - 1;
+  std::vector<RID> rids;
+  for (key = 1; key <= failed_key; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(key < failed_key, tree.GetValue(index_key, rids));
+  }
+
+  // the insertion waits until the frames are unpinned
+  bpm->SetFrameWaitTimeout(std::chrono::milliseconds(10000));
+  std::thread unpinner([bpm, &pinned] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    for (page_id_t pinned_id : pinned) {
+      bpm->UnpinPage(pinned_id, false);
+    }
+  });
+  index_key.SetFromInteger(failed_key);
+  rid.Set(0, failed_key);
+  EXPECT_EQ(true, tree.Insert(index_key, rid, transaction));
+  unpinner.join();
+  for (key = 1; key <= failed_key; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(true, tree.GetValue(index_key, rids));
+  }
+  EXPECT_LT(0, bpm->GetStats().frame_wait.count);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// trees built on larger pages find every key as well
+TEST(BPlusTreeTests, PageSizeTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t scale = 2000;
+
+  for (int page_size : {512, 4096, 16384}) {
+    DiskManager *disk_manager = new DiskManager("test.db", false, page_size);
+    BufferPoolManager *bpm = new BufferPoolManager(30, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                             comparator);
+    GenericKey<8> index_key;
+    RID rid;
+    Transaction *transaction = new Transaction(0);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(page_id);
+    (void)header_page;
+
+    for (int64_t key = 1; key <= scale; key++) {
+      rid.Set((int32_t)(key >> 32), key & 0xFFFFFFFF);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
+    std::vector<RID> rids;
+    for (int64_t key = 1; key <= scale; key++) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      tree.GetValue(index_key, rids);
+      ASSERT_EQ(1, rids.size());
+      EXPECT_EQ(key, rids[0].GetSlotNum());
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete transaction;
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
 } // namespace scudb
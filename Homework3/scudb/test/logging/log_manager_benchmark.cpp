@@ -0,0 +1,320 @@
+/**
+ * log_manager_benchmark.cpp
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concurrency/transaction_manager.h"
+#include "logging/common.h"
+#include "logging/log_manager.h"
+#include "logging/log_recovery.h"
+#include "logging/logged_pages.h"
+#include "page/header_page.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+// commits/sec of concurrent transactions with group commit, versus one log
+// write per commit, which is what committing one transaction at a time gives
+TEST(LogManagerTest, GroupCommitBenchmark) {
+  const int txns_per_thread = 100;
+  for (bool group_commit : {false, true}) {
+    for (int num_threads : {1, 4, 16}) {
+      DiskManager *disk_manager = new DiskManager("test.db");
+      LogManager *log_manager = new LogManager(disk_manager);
+      LockManager *lock_manager = new LockManager(false);
+      TransactionManager *txn_manager =
+          new TransactionManager(lock_manager, log_manager);
+      log_manager->RunFlushThread();
+
+      std::mutex commit_latch;
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> threads;
+      for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&] {
+          for (int i = 0; i < txns_per_thread; ++i) {
+            std::unique_lock<std::mutex> lock(commit_latch, std::defer_lock);
+            if (!group_commit) {
+              lock.lock();
+            }
+            Transaction *txn = txn_manager->Begin();
+            txn_manager->Commit(txn);
+            delete txn;
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+      log_manager->StopFlushThread();
+      std::cout << (group_commit ? "group commit" : "flush per commit")
+                << " threads: " << num_threads << " commits/sec: "
+                << (int64_t)(num_threads * txns_per_thread / elapsed.count())
+                << " log writes: " << disk_manager->GetNumFlushes()
+                << std::endl;
+
+      delete txn_manager;
+      delete lock_manager;
+      delete log_manager;
+      delete disk_manager;
+      remove("test.db");
+      remove("test.log");
+    }
+  }
+}
+
+// appends/sec from several threads with reservations, versus appends
+// serialized by one latch as before
+TEST(LogManagerTest, AppendBenchmark) {
+  const int records_per_thread = 50000;
+  for (bool latched : {true, false}) {
+    for (int num_threads : {1, 4, 16}) {
+      DiskManager *disk_manager = new DiskManager("test.db");
+      LogManager *log_manager = new LogManager(disk_manager);
+      log_manager->RunFlushThread();
+
+      std::mutex append_latch;
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> threads;
+      for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+          for (int i = 0; i < records_per_thread; ++i) {
+            LogRecord record(t, INVALID_LSN, LogRecordType::NEWPAGE,
+                             INVALID_PAGE_ID, i);
+            std::unique_lock<std::mutex> lock(append_latch, std::defer_lock);
+            if (latched) {
+              lock.lock();
+            }
+            log_manager->AppendLogRecord(record);
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+      log_manager->StopFlushThread();
+      std::cout << (latched ? "latched" : "reserved")
+                << " threads: " << num_threads << " appends/sec: "
+                << (int64_t)(num_threads * records_per_thread /
+                             elapsed.count())
+                << " log writes: " << disk_manager->GetNumFlushes()
+                << std::endl;
+
+      delete log_manager;
+      delete disk_manager;
+      remove("test.db");
+      remove("test.log");
+    }
+  }
+}
+
+// redo throughput of a log of small transactions over many pages, by
+// number of redo threads; nothing is written back, so every run redoes
+// the whole log
+TEST(LogManagerTest, RecoveryBenchmark) {
+  const int num_pages = 64;
+  const int num_txns = 20000;
+  std::string createStmt =
+      "a varchar, b smallint, c bigint, d bool, e varchar(16)";
+  Schema *schema = ParseCreateStatement(createStmt);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  LogManager *log_manager = new LogManager(disk_manager);
+  BufferPoolManager *bpm =
+      new BufferPoolManager(2 * num_pages, disk_manager, log_manager);
+  LoggedPages pages(bpm, log_manager);
+
+  std::vector<page_id_t> page_ids;
+  pages.Begin(0);
+  for (int i = 0; i < num_pages; ++i) {
+    page_ids.push_back(pages.NewPage(
+        0, page_ids.empty() ? INVALID_PAGE_ID : page_ids.back()));
+  }
+  pages.Commit(0);
+  // every transaction replaces the tuple it inserted into the page the last
+  // time round
+  std::vector<RID> last_rids(num_pages);
+  Tuple tuple = ConstructTuple(schema);
+  for (txn_id_t txn_id = 1; txn_id <= num_txns; ++txn_id) {
+    int i = txn_id % num_pages;
+    pages.Begin(txn_id);
+    if (txn_id > num_pages) {
+      pages.Delete(txn_id, last_rids[i]);
+    }
+    EXPECT_TRUE(pages.Insert(txn_id, page_ids[i], tuple, last_rids[i]));
+    pages.Commit(txn_id);
+  }
+  log_manager->WaitForFlush(pages.GetLastLSN());
+  delete bpm;
+  delete log_manager;
+
+  std::ifstream log_file("test.log", std::ios::binary | std::ios::ate);
+  double log_mb = log_file.tellg() / 1048576.0;
+  for (int num_workers : {1, 2, 4, 8}) {
+    bpm = new BufferPoolManager(2 * num_pages, disk_manager);
+    LogRecovery log_recovery(disk_manager, bpm, num_workers);
+    auto start = std::chrono::steady_clock::now();
+    log_recovery.Redo();
+    log_recovery.Undo();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::cout << "redo threads: " << num_workers << " log MB: " << log_mb
+              << " MB/sec: " << log_mb / elapsed.count() << std::endl;
+    EXPECT_EQ(pages.GetLastLSN() + 1, log_recovery.GetNextLSN());
+    delete bpm;
+  }
+
+  delete disk_manager;
+  delete schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+// recovery msec of a log of small transactions with a checkpoint taken at
+// nine tenths of it, right after the pages were written: redo from the master
+// record of that checkpoint, and from the start of the log once the header
+// page is reset and has no master record
+TEST(LogManagerTest, CheckpointBenchmark) {
+  const int num_pages = 64;
+  const int num_txns = 10000;
+  std::string createStmt =
+      "a varchar, b smallint, c bigint, d bool, e varchar(16)";
+  Schema *schema = ParseCreateStatement(createStmt);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  LogManager *log_manager = new LogManager(disk_manager);
+  BufferPoolManager *bpm =
+      new BufferPoolManager(2 * num_pages, disk_manager, log_manager);
+  LockManager lock_manager(true);
+  TransactionManager txn_manager(&lock_manager, log_manager);
+  CheckpointManager checkpoint_manager(&txn_manager, log_manager, bpm);
+  LoggedPages pages(bpm, log_manager, &txn_manager);
+
+  page_id_t header_page_id;
+  static_cast<HeaderPage *>(bpm->NewPage(header_page_id))->Init();
+  bpm->UnpinPage(header_page_id, true);
+  std::vector<page_id_t> page_ids;
+  pages.Begin(0);
+  for (int i = 0; i < num_pages; ++i) {
+    page_ids.push_back(pages.NewPage(
+        0, page_ids.empty() ? INVALID_PAGE_ID : page_ids.back()));
+  }
+  pages.Commit(0);
+  std::vector<RID> last_rids(num_pages);
+  Tuple tuple = ConstructTuple(schema);
+  for (txn_id_t txn_id = 1; txn_id <= num_txns; ++txn_id) {
+    int i = txn_id % num_pages;
+    pages.Begin(txn_id);
+    if (txn_id > num_pages) {
+      pages.Delete(txn_id, last_rids[i]);
+    }
+    EXPECT_TRUE(pages.Insert(txn_id, page_ids[i], tuple, last_rids[i]));
+    pages.Commit(txn_id);
+    if (txn_id == num_txns * 9 / 10) {
+      bpm->FlushAllPages();
+      EXPECT_TRUE(checkpoint_manager.Checkpoint());
+    }
+  }
+  delete bpm;
+  delete log_manager;
+
+  for (bool with_checkpoint : {true, false}) {
+    bpm = new BufferPoolManager(2 * num_pages, disk_manager);
+    if (!with_checkpoint) {
+      WritePageGuard guard = bpm->FetchPageWrite(HEADER_PAGE_ID);
+      static_cast<HeaderPage *>(guard.GetPage())->Init();
+      guard.MarkDirty();
+    }
+    LogRecovery log_recovery(disk_manager, bpm);
+    auto start = std::chrono::steady_clock::now();
+    log_recovery.Redo();
+    log_recovery.Undo();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::cout << "checkpoint: " << (with_checkpoint ? "yes" : "no")
+              << " recovery msec: " << elapsed.count() * 1000 << std::endl;
+    EXPECT_EQ(pages.GetLastLSN() + 1, log_recovery.GetNextLSN());
+    delete bpm;
+  }
+
+  delete disk_manager;
+  delete schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+// log bytes per update and commit throughput of single column updates of
+// wide tuples, logged with full images and as deltas
+TEST(LogManagerTest, DeltaUpdateBenchmark) {
+  const int num_tuples = 64;
+  const int num_txns = 2000;
+  const int updates_per_txn = 10;
+  std::string createStmt =
+      "a bigint, b bigint, c bigint, d bigint, e bigint, f bigint, g bigint, "
+      "h bigint, i bigint, j bigint, k bigint, l bigint, m varchar(64)";
+  Schema *schema = ParseCreateStatement(createStmt);
+  for (bool allow_delta : {false, true}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    LogManager *log_manager = new LogManager(disk_manager);
+    BufferPoolManager *bpm =
+        new BufferPoolManager(2 * num_tuples, disk_manager, log_manager);
+    LockManager lock_manager(true);
+    TransactionManager txn_manager(&lock_manager, log_manager);
+    LoggedPages pages(bpm, log_manager, &txn_manager);
+
+    std::vector<RID> rids(num_tuples);
+    std::vector<Tuple> tuples;
+    page_id_t page_id = INVALID_PAGE_ID;
+    pages.Begin(0);
+    for (RID &rid : rids) {
+      tuples.push_back(ConstructTuple(schema));
+      if (page_id == INVALID_PAGE_ID ||
+          !pages.Insert(0, page_id, tuples.back(), rid)) {
+        page_id = pages.NewPage(0, page_id);
+        ASSERT_TRUE(pages.Insert(0, page_id, tuples.back(), rid));
+      }
+    }
+    pages.Commit(0);
+
+    int log_size = disk_manager->GetLogSize();
+    std::mt19937 rng(25);
+    auto start = std::chrono::steady_clock::now();
+    for (txn_id_t txn_id = 1; txn_id <= num_txns; ++txn_id) {
+      pages.Begin(txn_id);
+      for (int i = 0; i < updates_per_txn; ++i) {
+        int tuple = rng() % num_tuples;
+        tuples[tuple] = SetColumn(tuples[tuple], schema, rng() % 12,
+                                  Value(TypeId::BIGINT, (int64_t)rng()));
+        EXPECT_TRUE(pages.Update(txn_id, rids[tuple], tuples[tuple],
+                                 allow_delta));
+      }
+      pages.Commit(txn_id);
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    double bytes = disk_manager->GetLogSize() - log_size;
+    std::cout << "delta: " << (allow_delta ? "yes" : "no")
+              << " log bytes/update: " << bytes / (num_txns * updates_per_txn)
+              << " commits/sec: " << num_txns / elapsed.count() << std::endl;
+
+    delete bpm;
+    delete log_manager;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete schema;
+}
+
+} // namespace scudb
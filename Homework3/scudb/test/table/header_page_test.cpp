@@ -5,12 +5,11 @@
 #include "page/header_page.h"
 #include "gtest/gtest.h"
 
-// NOTE: when you running this test, make sure page size(config.h) is at least
-// 4096
 namespace scudb {
 
 TEST(HeaderPageTest, UnitTest) {
-  DiskManager *disk_manager = new DiskManager("test.db");
+  // 27 records need a page of at least 4096 bytes
+  DiskManager *disk_manager = new DiskManager("test.db", false, 4096);
   BufferPoolManager *buffer_pool_manager =
       new BufferPoolManager(20, disk_manager);
   page_id_t header_page_id;
@@ -55,4 +54,79 @@ TEST(HeaderPageTest, UnitTest) {
   remove("test.db");
   remove("test.log");
 }
+
+// a database keeps the page size it was created with
+TEST(HeaderPageTest, PageSizeTest) {
+  DiskManager *disk_manager = new DiskManager("test.db", false, 16384);
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(20, disk_manager);
+  EXPECT_EQ(16384, buffer_pool_manager->GetPageSize());
+  page_id_t header_page_id;
+  HeaderPage *page =
+      static_cast<HeaderPage *>(buffer_pool_manager->NewPage(header_page_id));
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(16384, page->GetPageSize());
+  page->Init();
+  EXPECT_EQ(true, page->InsertRecord("foo", 1));
+  buffer_pool_manager->UnpinPage(header_page_id, true);
+  buffer_pool_manager->FlushPage(header_page_id);
+  delete buffer_pool_manager;
+  delete disk_manager;
+
+  // reopen asking for the default page size
+  disk_manager = new DiskManager("test.db");
+  EXPECT_EQ(16384, disk_manager->GetPageSize());
+  buffer_pool_manager = new BufferPoolManager(20, disk_manager);
+  page = static_cast<HeaderPage *>(
+      buffer_pool_manager->FetchPage(HEADER_PAGE_ID));
+  ASSERT_NE(nullptr, page);
+  page_id_t root_id;
+  EXPECT_EQ(true, page->GetRootId("foo", root_id));
+  EXPECT_EQ(1, root_id);
+  buffer_pool_manager->UnpinPage(HEADER_PAGE_ID, false);
+
+  delete buffer_pool_manager;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// the master record has its own place, records neither take it nor see it
+TEST(HeaderPageTest, MasterRecordTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(20, disk_manager);
+  page_id_t header_page_id;
+  HeaderPage *page =
+      static_cast<HeaderPage *>(buffer_pool_manager->NewPage(header_page_id));
+  ASSERT_NE(nullptr, page);
+  page->Init();
+  lsn_t checkpoint_lsn;
+  int64_t checkpoint_offset, redo_offset;
+  EXPECT_EQ(false,
+            page->GetMasterRecord(checkpoint_lsn, checkpoint_offset, redo_offset));
+
+  const int64_t large_offset = 5000000000LL;
+  page->SetMasterRecord(42, large_offset + 1, large_offset);
+  EXPECT_EQ(0, page->GetRecordCount());
+  EXPECT_EQ(true, page->InsertRecord("foo", 1));
+  EXPECT_EQ(true,
+            page->GetMasterRecord(checkpoint_lsn, checkpoint_offset, redo_offset));
+  EXPECT_EQ(42, checkpoint_lsn);
+  EXPECT_EQ(large_offset + 1, checkpoint_offset);
+  EXPECT_EQ(large_offset, redo_offset);
+  page_id_t root_id;
+  EXPECT_EQ(true, page->GetRootId("foo", root_id));
+  EXPECT_EQ(1, root_id);
+
+  page->Init();
+  EXPECT_EQ(false,
+            page->GetMasterRecord(checkpoint_lsn, checkpoint_offset, redo_offset));
+
+  buffer_pool_manager->UnpinPage(header_page_id, false);
+  delete buffer_pool_manager;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
 } // namespace scudb
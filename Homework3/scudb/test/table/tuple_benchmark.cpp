@@ -0,0 +1,136 @@
+/**
+ * tuple_benchmark.cpp
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "index/b_plus_tree.h"
+#include "logging/common.h"
+#include "table/table_heap.h"
+#include "table/tuple.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+void ScanResistance(ReplacerType replacer_type) {
+  Schema *schema = ParseCreateStatement("a varchar, b smallint, c bigint");
+  Tuple tuple = ConstructTuple(schema);
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_keys = 500;
+  const int num_tuples = 3000;
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(64, disk_manager, nullptr, replacer_type);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(page_id)); // header page
+  TableHeap *table =
+      new TableHeap(bpm, lock_manager, log_manager, transaction);
+  RID rid;
+  // much larger than the pool
+  for (int i = 0; i < num_tuples; ++i) {
+    ASSERT_EQ(true, table->InsertTuple(tuple, rid, transaction));
+  }
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  GenericKey<8> index_key;
+  for (int64_t key = 1; key <= num_keys; ++key) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+  // clean pages are evicted first, do not let that protect the index
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  bpm->UnpinPage(page_id, false);
+  for (page_id_t i = 0; i < page_id; ++i) {
+    bpm->FlushPage(i);
+  }
+
+  auto lookup_all = [&] {
+    std::vector<RID> rids;
+    GenericKey<8> key;
+    for (int64_t i = 1; i <= num_keys; ++i) {
+      rids.clear();
+      key.SetFromInteger(i);
+      tree.GetValue(key, rids);
+      EXPECT_EQ(1, rids.size());
+    }
+  };
+  auto scan = [&] {
+    int count = 0;
+    for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+      count++;
+    }
+    EXPECT_EQ(num_tuples, count);
+  };
+
+  for (AccessStrategy strategy :
+       {AccessStrategy::NORMAL, AccessStrategy::BULK_READ}) {
+    table->SetScanStrategy(strategy);
+    lookup_all();
+    uint64_t misses = bpm->GetStats().fetch_misses;
+    scan();
+    uint64_t scan_misses = bpm->GetStats().fetch_misses - misses;
+    misses += scan_misses;
+    lookup_all();
+    uint64_t index_misses = bpm->GetStats().fetch_misses - misses;
+
+    // lookups while another thread keeps scanning
+    std::atomic<bool> scanning(true);
+    std::thread scanner([&] {
+      while (scanning) {
+        scan();
+      }
+    });
+    int64_t lookups = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::nano> elapsed;
+    do {
+      lookup_all();
+      lookups += num_keys;
+      elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 2e8);
+    scanning = false;
+    scanner.join();
+    std::cout << "replacer: "
+              << (replacer_type == ReplacerType::LRU ? "lru" : "lru-k")
+              << " scan strategy: "
+              << (strategy == AccessStrategy::NORMAL ? "normal" : "bulk read")
+              << " scan misses: " << scan_misses
+              << " index misses after scan: " << index_misses
+              << " ns/lookup during scans: "
+              << (int64_t)(elapsed.count() / lookups) << std::endl;
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  remove("test.db");
+  remove("test.log");
+  delete table;
+  delete bpm;
+  delete disk_manager;
+  delete log_manager;
+  delete lock_manager;
+  delete transaction;
+  delete key_schema;
+  delete schema;
+}
+
+// index lookup latency while scans run concurrently, with and without the
+// bulk read strategy, for the default replacer and LRU-K
+TEST(TupleTest, ScanResistanceBenchmark) {
+  for (ReplacerType replacer_type : {ReplacerType::LRU, ReplacerType::LRU_K}) {
+    ScanResistance(replacer_type);
+  }
+}
+
+} // namespace scudb
@@ -5,10 +5,13 @@
 #include <algorithm>
 #include <cstdio>
 #include <iostream>
+#include <set>
 #include <string>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "index/b_plus_tree.h"
 #include "logging/common.h"
 #include "table/table_heap.h"
 #include "table/tuple.h"
@@ -61,4 +64,271 @@ TEST(TupleTest, TableHeapTest) {
   delete disk_manager;
 }
 
+// a scan reading ahead through a pool much smaller than the table sees every
+// tuple exactly once
+TEST(TupleTest, TableScanPrefetchTest) {
+  std::string createStmt = "a varchar, b smallint, c bigint";
+  Schema *schema = ParseCreateStatement(createStmt);
+  Tuple tuple = ConstructTuple(schema);
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(10, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+
+  RID rid;
+  std::set<int64_t> rids;
+  for (int i = 0; i < 2000; ++i) {
+    EXPECT_EQ(true, table->InsertTuple(tuple, rid, transaction));
+    rids.insert(rid.Get());
+  }
+
+  for (int window : {0, 1, 4}) {
+    table->SetPrefetchWindow(window);
+    std::set<int64_t> seen;
+    for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+      EXPECT_EQ(true, seen.insert(itr->GetRid().Get()).second);
+    }
+    EXPECT_EQ(rids, seen);
+  }
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete log_manager;
+  delete lock_manager;
+  delete transaction;
+}
+
+// a scan through the ring of a bulk read reads every page from disk once,
+// the pages it prefetches are not recycled before it gets to them, also with
+// the one frame ring of the default pool
+TEST(TupleTest, TableScanDiskReadsTest) {
+  Schema *schema = ParseCreateStatement("a varchar, b smallint, c bigint");
+  Tuple tuple = ConstructTuple(schema);
+  // number of instances (0 for a single pool) and frames
+  std::vector<std::pair<size_t, size_t>> pools = {
+      {0, BUFFER_POOL_SIZE}, {0, 64}, {4, 64}};
+
+  for (auto &pool : pools) {
+    SCOPED_TRACE(std::to_string(pool.first) + " x " +
+                 std::to_string(pool.second));
+    auto new_pool = [&pool](DiskManager *disk_manager) -> BufferPoolManager * {
+      if (pool.first == 0) {
+        return new BufferPoolManager(pool.second, disk_manager);
+      }
+      return new ParallelBufferPoolManager(pool.first, pool.second,
+                                           disk_manager);
+    };
+    Transaction *transaction = new Transaction(0);
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *buffer_pool_manager = new_pool(disk_manager);
+    LockManager *lock_manager = new LockManager(true);
+    LogManager *log_manager = new LogManager(disk_manager);
+    TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                     log_manager, transaction);
+    page_id_t first_page_id = table->GetFirstPageId();
+    RID rid;
+    for (int i = 0; i < 3000; ++i) {
+      ASSERT_EQ(true, table->InsertTuple(tuple, rid, transaction));
+    }
+    buffer_pool_manager->FlushAllPages();
+    delete table;
+    delete buffer_pool_manager;
+
+    // nothing resident
+    buffer_pool_manager = new_pool(disk_manager);
+    table = new TableHeap(buffer_pool_manager, lock_manager, log_manager,
+                          first_page_id);
+    std::set<page_id_t> page_ids;
+    for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+      page_ids.insert(itr->GetRid().GetPageId());
+    }
+    EXPECT_LT(pool.second, page_ids.size());
+    EXPECT_EQ(page_ids.size(),
+              buffer_pool_manager->GetStats().disk_read.count);
+
+    remove("test.db"); // remove db file
+    remove("test.log");
+    delete table;
+    delete buffer_pool_manager;
+    delete disk_manager;
+    delete log_manager;
+    delete lock_manager;
+    delete transaction;
+  }
+  delete schema;
+}
+
+// a scan that cannot read its page back because every frame is pinned throws
+// instead of reading through an empty guard, and so does one that cannot
+// start; an insert that cannot get to a page with space aborts
+TEST(TupleTest, TableScanOutOfFramesTest) {
+  Schema *schema = ParseCreateStatement("a varchar, b smallint, c bigint");
+  Tuple tuple = ConstructTuple(schema);
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(10, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+  table->SetPrefetchWindow(0);
+  RID rid;
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(true, table->InsertTuple(tuple, rid, transaction));
+  }
+
+  TableIterator itr = table->begin(transaction);
+  // pinning every frame evicts the page of the iterator
+  page_id_t page_id;
+  std::vector<page_id_t> pinned;
+  while (buffer_pool_manager->NewPage(page_id) != nullptr) {
+    pinned.push_back(page_id);
+  }
+  EXPECT_THROW(++itr, Exception);
+  for (page_id_t pinned_id : pinned) {
+    buffer_pool_manager->UnpinPage(pinned_id, false);
+  }
+  ++itr;
+  EXPECT_NE(table->end(), itr);
+
+  pinned.clear();
+  while (buffer_pool_manager->NewPage(page_id) != nullptr) {
+    pinned.push_back(page_id);
+  }
+  EXPECT_THROW(table->begin(transaction), Exception);
+  for (page_id_t pinned_id : pinned) {
+    buffer_pool_manager->UnpinPage(pinned_id, false);
+  }
+
+  // the first page is full and stays pinned, there is no frame for the next
+  page_id_t first_page_id = table->GetFirstPageId();
+  ASSERT_NE(nullptr, buffer_pool_manager->FetchPage(first_page_id));
+  pinned.clear();
+  while (buffer_pool_manager->NewPage(page_id) != nullptr) {
+    pinned.push_back(page_id);
+  }
+  EXPECT_EQ(false, table->InsertTuple(tuple, rid, transaction));
+  EXPECT_EQ(TransactionState::ABORTED, transaction->GetState());
+  buffer_pool_manager->UnpinPage(first_page_id, false);
+  for (page_id_t pinned_id : pinned) {
+    buffer_pool_manager->UnpinPage(pinned_id, false);
+  }
+  EXPECT_EQ(true, table->InsertTuple(tuple, rid, transaction));
+
+  remove("test.db"); // remove db file
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete log_manager;
+  delete lock_manager;
+  delete transaction;
+}
+
+// a full scan recycles a few frames instead of evicting the index pages from
+// the pool, also under LRU-K, which must not take the tuple by tuple reads of
+// a scanned page for repeated use
+TEST(TupleTest, ScanResistanceTest) {
+  Schema *schema = ParseCreateStatement("a varchar, b smallint, c bigint");
+  Tuple tuple = ConstructTuple(schema);
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_keys = 500;
+  const int num_tuples = 3000;
+
+  for (ReplacerType replacer_type : {ReplacerType::LRU, ReplacerType::LRU_K}) {
+    SCOPED_TRACE(replacer_type == ReplacerType::LRU ? "lru" : "lru-k");
+    Transaction *transaction = new Transaction(0);
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm =
+        new BufferPoolManager(64, disk_manager, nullptr, replacer_type);
+    LockManager *lock_manager = new LockManager(true);
+    LogManager *log_manager = new LogManager(disk_manager);
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(page_id)); // header page
+    TableHeap *table =
+        new TableHeap(bpm, lock_manager, log_manager, transaction);
+    // read ahead keeps frames of the ring loading in the background, which
+    // makes the scan take other frames now and then
+    table->SetPrefetchWindow(0);
+    RID rid;
+    // much larger than the pool
+    for (int i = 0; i < num_tuples; ++i) {
+      ASSERT_EQ(true, table->InsertTuple(tuple, rid, transaction));
+    }
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                             comparator);
+    GenericKey<8> index_key;
+    for (int64_t key = 1; key <= num_keys; ++key) {
+      rid.Set(0, key);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
+    // clean pages are evicted first, do not let that protect the index
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    bpm->UnpinPage(page_id, false);
+    for (page_id_t i = 0; i < page_id; ++i) {
+      bpm->FlushPage(i);
+    }
+
+    auto lookup_all = [&] {
+      std::vector<RID> rids;
+      GenericKey<8> key;
+      for (int64_t i = 1; i <= num_keys; ++i) {
+        rids.clear();
+        key.SetFromInteger(i);
+        tree.GetValue(key, rids);
+        EXPECT_EQ(1, rids.size());
+      }
+    };
+    auto scan = [&] {
+      int count = 0;
+      for (auto itr = table->begin(transaction); itr != table->end(); ++itr) {
+        count++;
+      }
+      EXPECT_EQ(num_tuples, count);
+    };
+    // index pages missed by the lookups that follow a scan
+    auto index_misses_after_scan = [&] {
+      lookup_all();
+      scan();
+      uint64_t misses = bpm->GetStats().fetch_misses;
+      lookup_all();
+      return bpm->GetStats().fetch_misses - misses;
+    };
+
+    if (replacer_type == ReplacerType::LRU) {
+      // LRU alone keeps the scanned pages over the index
+      table->SetScanStrategy(AccessStrategy::NORMAL);
+      EXPECT_LT(0u, index_misses_after_scan());
+    }
+    table->SetScanStrategy(AccessStrategy::BULK_READ);
+    EXPECT_EQ(0u, index_misses_after_scan());
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    remove("test.db");
+    remove("test.log");
+    delete table;
+    delete bpm;
+    delete disk_manager;
+    delete log_manager;
+    delete lock_manager;
+    delete transaction;
+  }
+  delete key_schema;
+  delete schema;
+}
+
 } // namespace scudb
@@ -0,0 +1,101 @@
+/**
+ * replacer_simulator.cpp
+ *
+ * Replays a trace recorded with BufferPoolManager::StartTrace() against the
+ * replacement policies of the buffer pool and prints their miss ratio for a
+ * range of pool sizes.
+ *
+ * usage: replacer_simulator <trace file> [pool size ...]
+ * Without pool sizes, powers of two from 8 up to twice the number of distinct
+ * pages in the trace are simulated, plus the size the trace was recorded
+ * with. A '*' marks a run in which some request found every frame pinned.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/replacer_simulator.h"
+
+using namespace scudb;
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <trace file> [pool size ...]\n", argv[0]);
+    return 1;
+  }
+  std::vector<TraceRecord> trace;
+  size_t recorded_pool_size = 0;
+  if (!AccessTraceRecorder::ReadTrace(argv[1], trace, &recorded_pool_size)) {
+    fprintf(stderr, "%s is not a trace file\n", argv[1]);
+    return 1;
+  }
+
+  std::unordered_set<page_id_t> pages;
+  size_t num_fetches = 0;
+  for (const TraceRecord &record : trace) {
+    pages.insert(record.pageId);
+    num_fetches += record.op == TraceOp::FETCH;
+  }
+  double seconds = trace.empty() ? 0 : trace.back().micros / 1e6;
+  printf("%zu records over %.3fs, %zu fetches of %zu distinct pages, "
+         "recorded with %zu frames\n",
+         trace.size(), seconds, num_fetches, pages.size(), recorded_pool_size);
+
+  std::vector<size_t> pool_sizes;
+  for (int i = 2; i < argc; ++i) {
+    pool_sizes.push_back(strtoul(argv[i], nullptr, 10));
+  }
+  if (pool_sizes.empty()) {
+    for (size_t size = 8; size < 2 * pages.size(); size *= 2) {
+      pool_sizes.push_back(size);
+    }
+    if (recorded_pool_size > 0) {
+      pool_sizes.push_back(recorded_pool_size);
+    }
+  }
+  std::sort(pool_sizes.begin(), pool_sizes.end());
+  pool_sizes.erase(std::unique(pool_sizes.begin(), pool_sizes.end()),
+                   pool_sizes.end());
+  pool_sizes.erase(std::remove(pool_sizes.begin(), pool_sizes.end(), 0),
+                   pool_sizes.end());
+
+  auto frame_index = [](const int &frame) { return static_cast<size_t>(frame); };
+  std::vector<std::pair<const char *,
+                        std::function<Replacer<int> *(size_t pool_size)>>>
+      policies = {
+          {"LRU", [](size_t) { return new LRUReplacer<int>(); }},
+          {"CLOCK",
+           [&](size_t pool_size) {
+             return new ClockReplacer<int>(pool_size, frame_index);
+           }},
+          {"LRU-K",
+           [&](size_t pool_size) {
+             return new LRUKReplacer<int>(pool_size, frame_index,
+                                          LRUK_REPLACER_K);
+           }},
+      };
+
+  std::vector<std::vector<SimulationResult>> curves;
+  printf("%10s", "frames");
+  for (auto &policy : policies) {
+    printf("%10s", policy.first);
+    curves.push_back(MissRatioCurve(trace, pool_sizes, policy.second));
+  }
+  printf("\n");
+  for (size_t i = 0; i < pool_sizes.size(); ++i) {
+    printf("%10zu", pool_sizes[i]);
+    for (auto &curve : curves) {
+      printf("%9.4f%c", curve[i].MissRatio(), curve[i].failures > 0 ? '*' : ' ');
+    }
+    printf("\n");
+  }
+  return 0;
+}